@@ -0,0 +1,104 @@
+// Benchmark for CmdPool
+//
+// Does basic attacks between hostile units of the example stage through the whole command pipeline, pushing a
+// CmdAction and doing Cmds until the queue is empty, and counts the allocations on the way. Pairs that could kill a
+// unit, as CombatForecast tells, are left out and HP is restored after each action, so the stage stays the same. The
+// first half of the actions warms the pool up and the second half is the steady state.
+//
+// Usage: bench_cmd_pool [actions] [seed]
+
+#include <atomic>
+#include <chrono>
+#include <new>
+
+#include "core/cmds.h"
+#include "core/combat_forecast.h"
+#include "core/scenario.h"
+#include "core/stage.h"
+#include "core/unit.h"
+#include "util/common.h"
+
+using namespace mengde::core;
+
+namespace {
+
+std::atomic<uint64_t> num_system_allocations{0};
+
+struct Counts {
+  uint64_t blocks;  // Handed out by CmdPool
+  uint64_t system;  // Allocations by the global operator new
+  std::chrono::steady_clock::time_point time;
+};
+
+Counts Now() { return {CmdPool::num_allocations(), num_system_allocations, std::chrono::steady_clock::now()}; }
+
+void Report(const char* name, const Counts& begin, const Counts& end, int actions) {
+  const double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end.time - begin.time).count();
+  printf("%-8s %10.2f %10.2f %10.1f\n", name, static_cast<double>(end.blocks - begin.blocks) / actions,
+         static_cast<double>(end.system - begin.system) / actions, ns / actions);
+}
+
+}  // namespace
+
+// Every allocation of the process is counted, including the ones of the libraries
+void* operator new(size_t size) {
+  num_system_allocations++;
+  if (void* p = malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { free(p); }
+
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+int main(int argc, char* argv[]) {
+  int num_actions = (argc > 1) ? atoi(argv[1]) : 100000;
+  uint64_t seed = (argc > 2) ? strtoull(argv[2], nullptr, 10) : 0;
+  Logger::GetInstance()->SetLevel(Logger::kLogFatal);
+
+  Scenario scenario("example");
+  Stage* stage = scenario.current_stage();
+  stage->Seed(seed);
+  stage->SubmitDeploy();
+
+  CombatForecast forecast(stage);
+  vector<std::pair<UId, UId>> pairs;
+  stage->ForEachUnitConst([&](const Unit* atk) {
+    stage->ForEachUnitConst([&](const Unit* def) {
+      if (atk->IsDead() || def->IsDead() || !atk->IsHostile(def)) return;
+      CombatForecast::Result result = forecast.ForecastBasicAttack(atk, atk->position(), def);
+      if (result.kill_rate == 0.0 && result.death_rate == 0.0) pairs.emplace_back(atk->uid(), def->uid());
+    });
+  });
+  printf("%d actions over %d pairs, seed %llu\n", num_actions, static_cast<int>(pairs.size()),
+         static_cast<unsigned long long>(seed));
+  if (pairs.empty()) return 0;
+
+  auto play = [&](int begin, int end) {
+    for (int i = begin; i < end; i++) {
+      const auto& pair = pairs[i % pairs.size()];
+      auto action = std::make_unique<CmdAction>();
+      action->SetCmdAct(std::make_unique<CmdBasicAttack>(pair.first, pair.second, CmdBasicAttack::Type::kActive));
+      stage->Push(std::move(action));
+      while (stage->HasNext()) stage->DoNext();
+      for (const UId& uid : {pair.first, pair.second}) {
+        Unit* unit = stage->LookupUnit(uid);
+        unit->RestoreHP(unit->GetOriginalHpMp().hp);
+      }
+    }
+  };
+
+  const int half = num_actions / 2;
+  printf("%-8s %10s %10s %10s\n", "", "blocks", "system", "ns");
+  Counts c0 = Now();
+  play(0, half);
+  Counts c1 = Now();
+  play(half, num_actions);
+  Counts c2 = Now();
+  Report("warm-up", c0, c1, std::max(half, 1));
+  Report("steady", c1, c2, std::max(num_actions - half, 1));
+  printf("per action; pool chunks %llu, large blocks %llu\n", static_cast<unsigned long long>(CmdPool::num_chunks()),
+         static_cast<unsigned long long>(CmdPool::num_large()));
+
+  return 0;
+}
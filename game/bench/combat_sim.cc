@@ -0,0 +1,69 @@
+// Benchmark for CombatSim
+//
+// Resolves a basic attack between every pair of hostile units of the example stage over and over, and reports the
+// throughput along with the estimates for the first pairs. The seed makes runs reproducible.
+//
+// Usage: bench_combat_sim [trials] [seed]
+
+#include <chrono>
+
+#include "core/cmds.h"
+#include "core/combat_sim.h"
+#include "core/scenario.h"
+#include "core/stage.h"
+#include "core/unit.h"
+#include "util/common.h"
+
+using namespace mengde::core;
+
+int main(int argc, char* argv[]) {
+  int trials = (argc > 1) ? atoi(argv[1]) : 10000;
+  uint64_t seed = (argc > 2) ? strtoull(argv[2], nullptr, 10) : 0;
+  Logger::GetInstance()->SetLevel(Logger::kLogFatal);
+
+  Scenario scenario("example");
+  Stage* stage = scenario.current_stage();
+  stage->SubmitDeploy();
+
+  vector<const Unit*> units;
+  stage->ForEachUnitConst([&](const Unit* unit) {
+    if (!unit->IsDead()) units.push_back(unit);
+  });
+
+  vector<unique_ptr<CmdAction>> actions;
+  for (auto atk : units) {
+    for (auto def : units) {
+      if (!atk->IsHostile(def)) continue;
+      auto action = std::make_unique<CmdAction>();
+      action->SetCmdAct(std::make_unique<CmdBasicAttack>(atk->uid(), def->uid(), CmdBasicAttack::Type::kActive));
+      actions.push_back(std::move(action));
+    }
+  }
+  printf("%d units, %d hostile pairs, %d trials each, seed %llu\n", static_cast<int>(units.size()),
+         static_cast<int>(actions.size()), trials, static_cast<unsigned long long>(seed));
+  if (actions.empty()) return 0;
+
+  CombatSim sim(stage);
+  Rng rng(seed);
+  vector<CombatSim::Estimate> estimates;
+
+  auto time_begin = std::chrono::steady_clock::now();
+  for (auto& action : actions) {
+    estimates.push_back(sim.EstimateAction(*action, trials, &rng));
+  }
+  auto time_end = std::chrono::steady_clock::now();
+
+  double num_actions = static_cast<double>(trials) * actions.size();
+  double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time_end - time_begin).count();
+  printf("%12.1f ns/action %12.0f actions/ms\n", ns / num_actions, num_actions / (ns / 1e6));
+
+  for (uint32_t i = 0; i < std::min<size_t>(estimates.size(), 5); i++) {
+    const CmdAct* act = actions[i]->cmd_act();
+    const CombatSim::Estimate& e = estimates[i];
+    printf("%-12s -> %-12s kill %5.3f death %5.3f dealt %6.1f taken %6.1f\n",
+           stage->LookupUnit(act->GetUnitAtk())->id().c_str(), stage->LookupUnit(act->GetUnitDef())->id().c_str(),
+           e.kill_rate, e.death_rate, e.damage_dealt, e.damage_taken);
+  }
+
+  return 0;
+}
@@ -0,0 +1,97 @@
+// Benchmark for the batch kernels of Formulae
+//
+// Evaluates the same random attacker and defender pairs with the scalar kernels one pair at a time and with the batch
+// kernels, and reports the time per pair of both. It fails if any result differs. The seed makes runs reproducible.
+//
+// Usage: bench_formulae [pairs] [iterations] [seed]
+
+#include <chrono>
+
+#include "core/formulae.h"
+#include "util/common.h"
+#include "util/rng.h"
+
+using namespace mengde::core;
+
+namespace {
+
+struct Pairs {
+  vector<int> atk, atk_effect, def, def_effect, level, dex_atk, dex_def;
+};
+
+double Measure(int iterations, int n, const function<void()>& run) {
+  auto time_begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    run();
+  }
+  auto time_end = std::chrono::steady_clock::now();
+  double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time_end - time_begin).count();
+  return ns / (static_cast<double>(iterations) * n);
+}
+
+void Report(const char* name, double scalar_ns, double batch_ns, bool match) {
+  printf("%-14s scalar %6.2f ns/pair  batch %6.2f ns/pair  %5.2fx  %s\n", name, scalar_ns, batch_ns,
+         scalar_ns / batch_ns, match ? "match" : "MISMATCH");
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  int n = (argc > 1) ? atoi(argv[1]) : 4096;
+  int iterations = (argc > 2) ? atoi(argv[2]) : 2000;
+  uint64_t seed = (argc > 3) ? strtoull(argv[3], nullptr, 10) : 0;
+
+  // Stats in the ranges of the game data, terrain effects in steps of 10%
+  Rng rng(seed);
+  Pairs p;
+  for (int i = 0; i < n; i++) {
+    p.atk.push_back(20 + rng.Gen(300));
+    p.def.push_back(20 + rng.Gen(300));
+    p.atk_effect.push_back(80 + rng.Gen(5) * 10);
+    p.def_effect.push_back(80 + rng.Gen(5) * 10);
+    p.level.push_back(1 + rng.Gen(60));
+    p.dex_atk.push_back(10 + rng.Gen(200));
+    p.dex_def.push_back(10 + rng.Gen(200));
+  }
+  printf("%d pairs, %d iterations, seed %llu\n", n, iterations, static_cast<unsigned long long>(seed));
+
+  vector<int> scalar(n), batch(n);
+  bool all_match = true;
+
+  double scalar_ns = Measure(iterations, n, [&]() {
+    for (int i = 0; i < n; i++) {
+      scalar[i] = Formulae::ComputeDamageBase(p.atk[i] * p.atk_effect[i] / 100, p.def[i] * p.def_effect[i] / 100,
+                                              p.level[i], Formulae::kDefaultRatio);
+    }
+  });
+  double batch_ns = Measure(iterations, n, [&]() {
+    Formulae::ComputeDamageBatch(n, p.atk.data(), p.atk_effect.data(), p.def.data(), p.def_effect.data(),
+                                 p.level.data(), Formulae::kDefaultRatio, batch.data());
+  });
+  Report("damage", scalar_ns, batch_ns, scalar == batch);
+  all_match = all_match && scalar == batch;
+
+  scalar_ns = Measure(iterations, n, [&]() {
+    for (int i = 0; i < n; i++) {
+      scalar[i] = Formulae::ComputeAccuracyBase(p.dex_atk[i], p.dex_def[i], Formulae::kDefaultRatio);
+    }
+  });
+  batch_ns = Measure(iterations, n, [&]() {
+    Formulae::ComputeAccuracyBatch(n, p.dex_atk.data(), p.dex_def.data(), Formulae::kDefaultRatio, batch.data());
+  });
+  Report("accuracy", scalar_ns, batch_ns, scalar == batch);
+  all_match = all_match && scalar == batch;
+
+  scalar_ns = Measure(iterations, n, [&]() {
+    for (int i = 0; i < n; i++) {
+      scalar[i] = Formulae::ComputeDoubleCriticalBase(p.dex_atk[i], p.dex_def[i]);
+    }
+  });
+  batch_ns = Measure(iterations, n, [&]() {
+    Formulae::ComputeDoubleCriticalBatch(n, p.dex_atk.data(), p.dex_def.data(), batch.data());
+  });
+  Report("double/crit", scalar_ns, batch_ns, scalar == batch);
+  all_match = all_match && scalar == batch;
+
+  return all_match ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+// Benchmark for movement queries
+//
+// Measures the time and the number of heap allocations per query, for the plain reachable cell query, for the
+// query that builds a PathTree and for the point-to-point query to the opposite side of the map.
+//
+// Usage: bench_path_finder [iterations]
+
+#include <atomic>
+#include <chrono>
+#include <new>
+
+#include "core/map.h"
+#include "core/path_tree.h"
+#include "core/scenario.h"
+#include "core/stage.h"
+#include "core/unit.h"
+#include "util/common.h"
+
+static std::atomic<uint64_t> num_allocs{0};
+
+void* operator new(size_t size) {
+  num_allocs++;
+  void* p = malloc(size);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+using namespace mengde::core;
+
+namespace {
+
+struct Result {
+  double ns_per_query;
+  double allocs_per_query;
+};
+
+Result Measure(int iterations, const vector<const Unit*>& units, const function<void(const Unit*)>& query) {
+  // Warm up, the first queries may grow the scratch buffers
+  for (auto unit : units) query(unit);
+
+  uint64_t allocs_begin = num_allocs;
+  auto time_begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    for (auto unit : units) query(unit);
+  }
+  auto time_end = std::chrono::steady_clock::now();
+  uint64_t allocs_end = num_allocs;
+
+  double num_queries = static_cast<double>(iterations) * units.size();
+  double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time_end - time_begin).count();
+  return {ns / num_queries, (allocs_end - allocs_begin) / num_queries};
+}
+
+void Print(const char* name, const Result& result) {
+  printf("%-20s %12.1f ns/query %10.2f allocs/query\n", name, result.ns_per_query, result.allocs_per_query);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  int iterations = (argc > 1) ? atoi(argv[1]) : 1000;
+  Logger::GetInstance()->SetLevel(Logger::kLogFatal);
+
+  Scenario scenario("example");
+  Stage* stage = scenario.current_stage();
+  stage->SubmitDeploy();
+  Map* map = stage->GetMap();
+
+  vector<const Unit*> units;
+  stage->ForEachUnitConst([&](const Unit* unit) {
+    if (!unit->IsDead()) units.push_back(unit);
+  });
+  printf("%d units on a %dx%d map, %d iterations\n", static_cast<int>(units.size()), map->GetSize().x,
+         map->GetSize().y, iterations);
+
+  vector<Vec2D> cells;
+  Print("FindMovablePos",
+        Measure(iterations, units, [&](const Unit* unit) { map->FindMovablePos(unit->uid(), &cells); }));
+  Print("FindMovablePath", Measure(iterations, units, [&](const Unit* unit) {
+          unique_ptr<PathTree> tree(map->FindMovablePath(unit->uid()));
+        }));
+  Print("FindPathTo", Measure(iterations, units, [&](const Unit* unit) {
+          map->FindPathTo(unit->uid(), map->GetSize() - unit->position() - 1);
+        }));
+
+  return 0;
+}
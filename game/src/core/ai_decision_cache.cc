@@ -0,0 +1,113 @@
+#include "ai_decision_cache.h"
+
+#include "map.h"
+#include "stage.h"
+#include "unit.h"
+
+namespace mengde {
+namespace core {
+
+namespace {
+
+const int kNumHpBuckets = 4;
+const size_t kMaxDecisions = 1 << 16;  // The cache starts over when it is full
+
+enum Feature : uint32_t { kTerrain = 1, kOutside, kUnit, kClass, kMove, kSelf, kMode };
+
+// The Zobrist key of a feature at an offset. Instead of a table of random numbers, the index is scrambled with
+// SplitMix64, which is as good for XOR hashing and needs no bounds on offsets or feature values.
+uint64_t ZobristKey(Vec2D offset, Feature feature, uint32_t value) {
+  uint64_t z = (static_cast<uint64_t>(static_cast<uint16_t>(offset.x)) << 48) |
+               (static_cast<uint64_t>(static_cast<uint16_t>(offset.y)) << 32) |
+               (static_cast<uint64_t>(feature) << 24) | (value & 0xFFFFFF);
+  z += 0x9E3779B97F4A7C15ull;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+// HP bucket and conditions of a unit
+uint32_t UnitState(const Unit* unit) {
+  const int hp = unit->GetCurrentHpMp().hp;
+  const int max_hp = std::max(unit->GetOriginalHpMp().hp, 1);
+  uint32_t state = std::min(std::max(hp, 0) * kNumHpBuckets / max_hp, kNumHpBuckets - 1);
+  unit->condition_set().Iterate([&](Condition condition, TurnBased) { state |= 4u << static_cast<int>(condition); });
+  return state;
+}
+
+}  // namespace
+
+AIDecisionCache::AIDecisionCache(Stage* stage)
+    : stage_(stage),
+      map_size_(stage->GetMap()->GetSize()),
+      terrains_(stage->GetMap()->GetTerrainIndices()),
+      terrain_keys_(map_size_.x * map_size_.y),
+      decisions_(),
+      num_hits_(0),
+      num_misses_(0) {}
+
+uint64_t AIDecisionCache::Key(const Unit* unit, AIMode mode, int radius) {
+  const Vec2D pos = unit->position();
+  uint64_t key = TerrainKey(pos, radius);
+  key ^= ZobristKey({0, 0}, kClass, unit->class_index());
+  key ^= ZobristKey({0, 0}, kMove, unit->move());
+  key ^= ZobristKey({0, 0}, kSelf, UnitState(unit));
+  key ^= ZobristKey({0, 0}, kMode, static_cast<uint32_t>(mode));
+
+  stage_->ForEachUnitConst([&](const Unit* other) {
+    if (other == unit || other->IsDead()) return;
+    const Vec2D d = other->position() - pos;
+    if (std::abs(d.x) + std::abs(d.y) > radius) return;
+    key ^= ZobristKey(d, kUnit, (UnitState(other) << 1) | (unit->IsHostile(other) ? 1 : 0));
+  });
+  return key;
+}
+
+bool AIDecisionCache::Find(uint64_t key, Decision* decision) {
+  auto found = decisions_.find(key);
+  if (found == decisions_.end()) {
+    num_misses_++;
+    return false;
+  }
+  num_hits_++;
+  *decision = found->second;
+  return true;
+}
+
+void AIDecisionCache::Insert(uint64_t key, const Decision& decision) {
+  if (decisions_.size() >= kMaxDecisions) decisions_.clear();
+  decisions_[key] = decision;
+}
+
+void AIDecisionCache::Remove(uint64_t key) {
+  // The decision found did not fit, so it was a miss after all
+  if (decisions_.erase(key) > 0) {
+    num_hits_--;
+    num_misses_++;
+  }
+}
+
+uint64_t AIDecisionCache::TerrainKey(Vec2D pos, int radius) {
+  vector<uint64_t>& keys = terrain_keys_[pos.y * map_size_.x + pos.x];
+  if (keys.size() <= static_cast<size_t>(radius)) keys.resize(radius + 1, 0);
+  if (keys[radius] != 0) return keys[radius];
+
+  uint64_t key = 0;
+  for (int dy = -radius; dy <= radius; dy++) {
+    const int y = pos.y + dy;
+    const int span = radius - std::abs(dy);
+    for (int dx = -span; dx <= span; dx++) {
+      const int x = pos.x + dx;
+      if (0 <= x && x < map_size_.x && 0 <= y && y < map_size_.y) {
+        key ^= ZobristKey({dx, dy}, kTerrain, terrains_[y * map_size_.x + x]);
+      } else {
+        key ^= ZobristKey({dx, dy}, kOutside, 0);
+      }
+    }
+  }
+  keys[radius] = key;
+  return key;
+}
+
+}  // namespace core
+}  // namespace mengde
@@ -0,0 +1,60 @@
+#ifndef MENGDE_CORE_AI_DECISION_CACHE_H_
+#define MENGDE_CORE_AI_DECISION_CACHE_H_
+
+#include <unordered_map>
+
+#include "ai_mode.h"
+#include "cmds.h"
+#include "util/common.h"
+
+namespace mengde {
+namespace core {
+
+class Stage;
+class Unit;
+
+// AIDecisionCache remembers what AI units decided in a local situation, to answer the same situation without queries
+//
+// A situation is keyed by a Zobrist hash of the board around the unit, within `radius` cells of it: the terrain of
+// every cell, and the relation(friendly or hostile), HP bucket and conditions of every unit, plus the unit's own
+// class, move points, HP bucket and conditions. Cells are hashed by their offset from the unit, so the same situation
+// elsewhere on the map is the same key, and a decision is kept relative to the unit's position too. It is up to the
+// AI mode to pass a radius that covers everything its decision depends on.
+//
+// The terrain part never changes during a stage and is memoized per cell and radius. A decision that no longer fits
+// the queries, which would take a hash collision, is reported by the caller with `Remove`.
+
+class AIDecisionCache {
+ public:
+  struct Decision {
+    Vec2D move;  // Offset of the destination
+    ActionType type;
+    Vec2D target;  // Offset of the target, for ActionType::kBasicAttack
+  };
+
+ public:
+  AIDecisionCache(Stage* stage);
+  uint64_t Key(const Unit* unit, AIMode mode, int radius);
+  bool Find(uint64_t key, Decision* decision);
+  void Insert(uint64_t key, const Decision& decision);
+  void Remove(uint64_t key);
+  uint32_t num_hits() const { return num_hits_; }
+  uint32_t num_misses() const { return num_misses_; }
+
+ private:
+  uint64_t TerrainKey(Vec2D pos, int radius);
+
+ private:
+  Stage* stage_;
+  Vec2D map_size_;
+  const uint8_t* terrains_;                // Terrain index of each cell, owned by Map
+  vector<vector<uint64_t>> terrain_keys_;  // Indexed by cell then radius, 0 if not computed yet
+  std::unordered_map<uint64_t, Decision> decisions_;
+  uint32_t num_hits_;
+  uint32_t num_misses_;
+};
+
+}  // namespace core
+}  // namespace mengde
+
+#endif  // MENGDE_CORE_AI_DECISION_CACHE_H_
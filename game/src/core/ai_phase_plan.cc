@@ -0,0 +1,60 @@
+#include "ai_phase_plan.h"
+
+#include "cmds.h"
+#include "stage.h"
+#include "unit.h"
+
+namespace mengde {
+namespace core {
+
+namespace {
+
+const Vec2D kDead{-1, -1};
+
+}  // namespace
+
+AIPhasePlan::AIPhasePlan(const Stage* stage, vector<Action> actions)
+    : actions_(std::move(actions)),
+      next_(0),
+      turn_(stage->GetTurn().current()),
+      force_(stage->GetTurn().force()),
+      positions_(GetPositions(stage)) {}
+
+bool AIPhasePlan::HasNext(const Stage* stage) const {
+  if (next_ == actions_.size()) return false;
+  if (stage->GetTurn().current() != turn_ || stage->GetTurn().force() != force_) return false;
+
+  const vector<Vec2D> positions = GetPositions(stage);
+  if (positions.size() != positions_.size()) return false;
+  for (uint32_t i = 0; i < positions.size(); i++) {
+    if (positions[i] == positions_[i]) continue;
+    // Deaths are only told by the next action, so they are fine as long as the rest of the plan does not count on them
+    if (positions[i] != kDead || IsInvolved(UId{i})) return false;
+  }
+  return true;
+}
+
+unique_ptr<Cmd> AIPhasePlan::Next(const Stage* stage) {
+  if (!HasNext(stage)) return nullptr;
+  const Action& action = actions_[next_++];
+  positions_ = GetPositions(stage);
+  positions_[action.unit.Value()] = action.candidate.pos;
+  return action.candidate.ToCmdAction(action.unit);
+}
+
+vector<Vec2D> AIPhasePlan::GetPositions(const Stage* stage) {
+  vector<Vec2D> positions;
+  stage->ForEachUnitConst(
+      [&positions](const Unit* unit) { positions.push_back(unit->IsDead() ? kDead : unit->position()); });
+  return positions;
+}
+
+bool AIPhasePlan::IsInvolved(const UId& uid) const {
+  for (uint32_t i = next_; i < actions_.size(); i++) {
+    if (actions_[i].unit == uid || actions_[i].candidate.target == uid) return true;
+  }
+  return false;
+}
+
+}  // namespace core
+}  // namespace mengde
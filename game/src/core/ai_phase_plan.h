@@ -0,0 +1,49 @@
+#ifndef MENGDE_CORE_AI_PHASE_PLAN_H_
+#define MENGDE_CORE_AI_PHASE_PLAN_H_
+
+#include "cmd.h"
+#include "force.h"
+#include "utility_scorer.h"
+
+namespace mengde {
+namespace core {
+
+class Stage;
+
+// AIPhasePlan is the rest of a phase planned at once, which CmdPlayAI plays one action at a time
+//
+// Planning takes far longer than playing an action, so the stage keeps the plan and the next action is taken from it
+// as long as the stage is what the actions played so far leave. It is not once a unit was generated or moved other
+// than by them, like by the Lua events run at the end of an action, or a unit the rest of the plan acts with or on is
+// dead, like from a counter-attack. Then the rest of the phase is planned again. HP and stats are not checked, as they
+// may make the rest of the plan worse but not illegal.
+
+class AIPhasePlan {
+ public:
+  struct Action {
+    UId unit;
+    UtilityCandidate candidate;
+  };
+
+ public:
+  AIPhasePlan(const Stage* stage, vector<Action> actions);
+  bool HasNext(const Stage* stage) const;
+  // Returns nullptr unless `HasNext`
+  unique_ptr<Cmd> Next(const Stage* stage);
+
+ private:
+  static vector<Vec2D> GetPositions(const Stage* stage);
+  bool IsInvolved(const UId& uid) const;
+
+ private:
+  vector<Action> actions_;
+  uint32_t next_;
+  uint16_t turn_;
+  Force force_;
+  vector<Vec2D> positions_;  // Indexed by UId, expected at the next action and {-1, -1} for dead units
+};
+
+}  // namespace core
+}  // namespace mengde
+
+#endif  // MENGDE_CORE_AI_PHASE_PLAN_H_
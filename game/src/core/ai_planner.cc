@@ -0,0 +1,127 @@
+#include "ai_planner.h"
+
+#include <numeric>
+
+#include "map.h"
+#include "stage.h"
+#include "turn.h"
+#include "unit.h"
+#include "user_interface.h"
+#include "util/rng.h"
+#include "util/thread_pool.h"
+
+namespace mengde {
+namespace core {
+
+namespace {
+
+const int kNumOrderings = 8;
+
+}  // namespace
+
+AIPlanner::AIPlanner(Stage* stage) : stage_(stage), ui_(stage->user_interface()) {}
+
+unique_ptr<AIPhasePlan> AIPlanner::Plan() {
+  AvailableUnits units = ui_->QueryUnits();
+  if (units.Count() == 0) {
+    return std::make_unique<AIPhasePlan>(stage_, vector<AIPhasePlan::Action>());
+  }
+
+  // Queries go through the session which is not thread safe, so they are done up front
+  vector<AvailableMoves> moves;
+  for (uint32_t i = 0; i < units.Count(); i++) {
+    units_.push_back(units.Get(UnitKey{i}));
+    moves.push_back(ui_->QueryMoves(UnitKey{i}));
+  }
+  ui_->ForEachUnit([&](const Unit* unit) {
+    hps_.push_back(unit->GetCurrentHpMp().hp);
+    max_hps_.push_back(unit->GetOriginalHpMp().hp);
+  });
+
+  const Force force = ui_->GetUnit(units_[0])->force();
+  UtilityScorer scorer(ui_, force);
+  candidates_.resize(units_.size());
+  ThreadPool::GetInstance()->ParallelFor(units_.size(), [&](int i) {
+    candidates_[i] = scorer.Evaluate(ui_->GetUnit(units_[i]), moves[i]);
+  });
+
+  // Orderings to try: as queried, the strongest single action first, the fewest options first and some shuffles
+  vector<PhasePlan> plans(kNumOrderings);
+  vector<uint32_t> identity(units_.size());
+  std::iota(identity.begin(), identity.end(), 0);
+  vector<double> best_scores(units_.size(), 0.0);
+  for (uint32_t i = 0; i < units_.size(); i++) {
+    for (auto& c : candidates_[i]) {
+      double score = c.target ? c.Score(hps_[c.target.Value()], max_hps_[c.target.Value()]) : c.Score(0, 0);
+      best_scores[i] = std::max(best_scores[i], score);
+    }
+  }
+  Rng rng = ui_->GetAIRng()->Split();
+  for (int i = 0; i < kNumOrderings; i++) {
+    vector<uint32_t>& order = plans[i].order;
+    order = identity;
+    if (i == 1) {
+      std::stable_sort(order.begin(), order.end(),
+                       [&](uint32_t a, uint32_t b) { return best_scores[a] > best_scores[b]; });
+    } else if (i == 2) {
+      std::stable_sort(order.begin(), order.end(),
+                       [&](uint32_t a, uint32_t b) { return candidates_[a].size() < candidates_[b].size(); });
+    } else if (i > 2) {
+      for (uint32_t j = order.size(); j > 1; j--) {
+        std::swap(order[j - 1], order[rng.Gen(j)]);
+      }
+    }
+  }
+  ThreadPool::GetInstance()->ParallelFor(kNumOrderings, [&](int i) { Simulate(&plans[i]); });
+
+  // Ties go to the first ordering so the result does not depend on the scheduling
+  const PhasePlan* best = &plans[0];
+  for (const PhasePlan& plan : plans) {
+    if (plan.score > best->score) best = &plan;
+  }
+
+  vector<AIPhasePlan::Action> actions;
+  for (uint32_t unit : best->order) {
+    actions.push_back({units_[unit], candidates_[unit][best->picks[unit]]});
+  }
+  return std::make_unique<AIPhasePlan>(stage_, std::move(actions));
+}
+
+void AIPlanner::Simulate(PhasePlan* plan) const {
+  const Vec2D map_size = ui_->GetMapSize();
+  vector<bool> reserved(map_size.x * map_size.y, false);
+  vector<double> hps(hps_.begin(), hps_.end());
+
+  plan->score = 0.0;
+  plan->picks.assign(units_.size(), 0);
+  for (uint32_t unit : plan->order) {
+    const vector<UtilityCandidate>& candidates = candidates_[unit];
+    int best = -1;
+    double best_score = 0.0;
+    for (uint32_t i = 0; i < candidates.size(); i++) {
+      const UtilityCandidate& c = candidates[i];
+      if (reserved[c.pos.y * map_size.x + c.pos.x]) continue;
+      double score =
+          c.target ? c.Score(static_cast<int>(hps[c.target.Value()]), max_hps_[c.target.Value()]) : c.Score(0, 0);
+      if (best == -1 || score > best_score) {
+        best = i;
+        best_score = score;
+      }
+    }
+
+    // Every unit can stay where it is, a cell no one else can pick
+    ASSERT(best != -1);
+    const UtilityCandidate& pick = candidates[best];
+    reserved[pick.pos.y * map_size.x + pick.pos.x] = true;
+    if (pick.kind == UtilityCandidate::Kind::kDamage) {
+      hps[pick.target.Value()] -= pick.dealt;
+    } else if (pick.kind == UtilityCandidate::Kind::kHeal) {
+      hps[pick.target.Value()] += pick.hit * pick.amount;
+    }
+    plan->picks[unit] = best;
+    plan->score += best_score;
+  }
+}
+
+}  // namespace core
+}  // namespace mengde
@@ -0,0 +1,50 @@
+#ifndef MENGDE_CORE_AI_PLANNER_H_
+#define MENGDE_CORE_AI_PLANNER_H_
+
+#include "ai_phase_plan.h"
+#include "utility_scorer.h"
+
+namespace mengde {
+namespace core {
+
+class Stage;
+class UserInterface;
+
+// AIPlanner plans the whole phase of the current force at once
+//
+// Candidates of every unit are scored once with UtilityScorer, then units pick their actions one after another:
+// - A cell picked by a unit is reserved and not available to the units after it
+// - The expected damage of a picked action is taken off the target's HP, so the units after it do not waste attacks
+//   on a target that is likely dead already and rather finish off the ones that are not
+// The result depends on which unit picks first, so several orderings are tried in parallel and the one with the
+// highest total score is kept. CmdPlayAI plays it one action at a time as an AIPhasePlan, and plans again only when the
+// stage changed in ways the plan could not foresee. A plan with no action is returned when no unit is left.
+// Units are planned regardless of their own AIMode.
+
+class AIPlanner {
+ public:
+  AIPlanner(Stage* stage);
+  unique_ptr<AIPhasePlan> Plan();
+
+ private:
+  struct PhasePlan {
+    double score;
+    vector<uint32_t> order;  // Unit indices in the order to play
+    vector<uint32_t> picks;  // Candidate index for each unit
+  };
+
+  void Simulate(PhasePlan* plan) const;
+
+ private:
+  Stage* stage_;
+  UserInterface* ui_;
+  vector<UId> units_;
+  vector<vector<UtilityCandidate>> candidates_;  // For each unit
+  vector<int> hps_;                              // Indexed by UId
+  vector<int> max_hps_;                          // Indexed by UId
+};
+
+}  // namespace core
+}  // namespace mengde
+
+#endif  // MENGDE_CORE_AI_PLANNER_H_
@@ -0,0 +1,282 @@
+#include "ai_search.h"
+
+#include <chrono>
+#include <cmath>
+#include <numeric>
+
+#include "map.h"
+#include "stage.h"
+#include "turn.h"
+#include "unit.h"
+#include "user_interface.h"
+#include "util/thread_pool.h"
+
+namespace mengde {
+namespace core {
+
+namespace {
+
+const uint32_t kMaxBranches = 8;     // Candidates of a unit to search, the rest are hardly ever the best
+const uint32_t kMaxNodes = 1 << 20;  // Nodes are not expanded any further beyond this
+const double kExploration = 0.5;     // UCB1 constant for rewards scaled to [0, 1]
+
+}  // namespace
+
+AISearch::AISearch(Stage* stage)
+    : stage_(stage),
+      map_size_(stage->GetMap()->GetSize()),
+      sim_(stage),
+      nodes_(1, Node{0, 0, 0, 0, 0.0}),
+      min_reward_(0.0),
+      max_reward_(0.0),
+      iterations_(0),
+      stop_(false) {
+  UserInterface* ui = stage->user_interface();
+  AvailableUnits units = ui->QueryUnits();
+  if (units.Count() == 0) return;
+
+  vector<UId> uids;
+  vector<AvailableMoves> moves;
+  for (uint32_t i = 0; i < units.Count(); i++) {
+    uids.push_back(units.Get(UnitKey{i}));
+    moves.push_back(ui->QueryMoves(UnitKey{i}));
+  }
+
+  const Force force = ui->GetUnit(uids[0])->force();
+  ui->ForEachUnit([&](const Unit* unit) {
+    max_hps_.push_back(unit->GetOriginalHpMp().hp);
+    sides_.push_back(unit->IsDead() ? 0 : (IsHostile(force, unit->force()) ? 1 : -1));
+  });
+  rng_ = stage->ai_rng()->Split();  // Drawn from on the worker when the search runs on AISearchTask
+
+  UtilityScorer scorer(ui, force);
+  vector<vector<UtilityCandidate>> all(uids.size());
+  ThreadPool::GetInstance()->ParallelFor(uids.size(), [&](int i) {
+    all[i] = scorer.Evaluate(ui->GetUnit(uids[i]), moves[i]);
+  });
+
+  // Keep the best candidates of each unit, and the best one at the unit's own cell which is always available
+  vector<vector<UtilityCandidate>> kept(uids.size());
+  vector<double> best_scores(uids.size(), 0.0);
+  for (uint32_t i = 0; i < uids.size(); i++) {
+    const vector<UtilityCandidate>& candidates = all[i];
+    vector<double> scores;
+    for (const UtilityCandidate& c : candidates) {
+      scores.push_back(c.target ? c.Score(sim_.GetHP(c.target), max_hps_[c.target.Value()]) : c.Score(0, 0));
+    }
+    vector<uint32_t> indices(candidates.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    std::stable_sort(indices.begin(), indices.end(), [&](uint32_t a, uint32_t b) { return scores[a] > scores[b]; });
+
+    const Vec2D origin = ui->GetUnit(uids[i])->position();
+    bool has_origin = false;
+    for (uint32_t j = 0; j < indices.size(); j++) {
+      const UtilityCandidate& c = candidates[indices[j]];
+      if (j < kMaxBranches || (!has_origin && c.pos == origin)) {
+        has_origin = has_origin || c.pos == origin;
+        kept[i].push_back(c);
+      }
+    }
+    ASSERT(has_origin);
+    best_scores[i] = scores[indices[0]];
+  }
+
+  // Play the strongest single action first, as one of AIPlanner's orderings does
+  vector<uint32_t> order(uids.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return best_scores[a] > best_scores[b]; });
+  for (uint32_t i : order) {
+    units_.push_back(uids[i]);
+    candidates_.push_back(std::move(kept[i]));
+  }
+}
+
+void AISearch::Search(int budget_ms, uint32_t max_iterations) {
+  if (units_.empty()) return;
+
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(budget_ms);
+  while (!stop_ && iterations_ < max_iterations && std::chrono::steady_clock::now() < deadline) {
+    Iterate();
+  }
+}
+
+void AISearch::Iterate() {
+  CombatSim sim = sim_;
+  vector<bool> reserved(map_size_.x * map_size_.y, false);
+  vector<uint32_t> path = {0};
+  double reward = 0.0;
+
+  // Selection and expansion, which stop at a node that has never been visited
+  uint32_t depth = 0;
+  for (uint32_t node = 0; depth < units_.size(); depth++) {
+    if (nodes_[node].num_children == 0) {
+      if (node != 0 && nodes_[node].visits == 0) break;
+      if (!Expand(node, depth, reserved)) break;
+    }
+    node = SelectChild(nodes_[node]);
+    reward += Play(depth, candidates_[depth][nodes_[node].pick], &sim, &reserved);
+    path.push_back(node);
+  }
+
+  // Rollout
+  for (; depth < units_.size(); depth++) {
+    int pick = PickGreedy(depth, reserved, [&](const UId& uid) { return sim.GetHP(uid); });
+    reward += Play(depth, candidates_[depth][pick], &sim, &reserved);
+  }
+
+  // Outcome of the dice rolls, in the same units as UtilityCandidate::Score
+  for (uint32_t i = 0; i < sides_.size(); i++) {
+    const UId uid{i};
+    const int before = std::max(sim_.GetHP(uid), 0);
+    const int after = std::max(sim.GetHP(uid), 0);
+    const double killed = (before > 0 && after == 0) ? UtilityScorer::kKillBonus : 0.0;
+    if (sides_[i] > 0) {
+      reward += before - after + killed;
+    } else if (sides_[i] < 0) {
+      reward += (after < before) ? -(before - after + killed) * UtilityScorer::kCounterWeight : after - before;
+    }
+  }
+
+  for (uint32_t node : path) {
+    nodes_[node].visits++;
+    nodes_[node].total += reward;
+  }
+  if (iterations_ == 0) {
+    min_reward_ = max_reward_ = reward;
+  } else {
+    min_reward_ = std::min(min_reward_, reward);
+    max_reward_ = std::max(max_reward_, reward);
+  }
+  iterations_++;
+}
+
+bool AISearch::Expand(uint32_t node, uint32_t depth, const vector<bool>& reserved) {
+  const vector<UtilityCandidate>& candidates = candidates_[depth];
+  if (nodes_.size() + candidates.size() > kMaxNodes) return false;
+
+  const uint32_t first_child = nodes_.size();
+  for (uint32_t i = 0; i < candidates.size(); i++) {
+    if (!reserved[CellIndex(candidates[i].pos)]) {
+      nodes_.push_back(Node{i, 0, 0, 0, 0.0});
+    }
+  }
+  ASSERT_GT(nodes_.size(), first_child);
+  nodes_[node].first_child = first_child;
+  nodes_[node].num_children = nodes_.size() - first_child;
+  return true;
+}
+
+uint32_t AISearch::SelectChild(const Node& node) const {
+  const double range = max_reward_ - min_reward_;
+  const double log_visits = std::log(static_cast<double>(node.visits));
+  uint32_t best = node.first_child;
+  double best_ucb = 0.0;
+  for (uint32_t i = node.first_child; i < node.first_child + node.num_children; i++) {
+    const Node& child = nodes_[i];
+    if (child.visits == 0) return i;
+
+    const double mean = child.total / child.visits;
+    const double ucb = (range > 0.0 ? (mean - min_reward_) / range : 0.0) +
+                       kExploration * std::sqrt(log_visits / child.visits);
+    if (i == node.first_child || ucb > best_ucb) {
+      best = i;
+      best_ucb = ucb;
+    }
+  }
+  return best;
+}
+
+double AISearch::Play(uint32_t unit, const UtilityCandidate& c, CombatSim* sim, vector<bool>* reserved) {
+  (*reserved)[CellIndex(c.pos)] = true;
+
+  const UId& uid = units_[unit];
+  if (sim->IsDead(uid)) return 0.0;  // Killed by a counter-attack earlier in this phase
+
+  sim->Move(uid, c.pos);
+  if (c.type == ActionType::kBasicAttack) {
+    sim->DoBasicAttack(uid, c.target, &rng_);
+  } else if (c.type == ActionType::kMagic) {
+    sim->DoMagic(uid, c.target, c.magic, &rng_);
+  }
+
+  // What the simulation can not tell, the HP effects are in the outcome
+  const bool hp_effect = (c.kind == UtilityCandidate::Kind::kDamage || c.kind == UtilityCandidate::Kind::kHeal);
+  return hp_effect ? c.base : c.Score(0, 0);
+}
+
+int AISearch::PickGreedy(uint32_t unit, const vector<bool>& reserved,
+                         const std::function<int(const UId&)>& get_hp) const {
+  const vector<UtilityCandidate>& candidates = candidates_[unit];
+  int best = -1;
+  double best_score = 0.0;
+  for (uint32_t i = 0; i < candidates.size(); i++) {
+    const UtilityCandidate& c = candidates[i];
+    if (reserved[CellIndex(c.pos)]) continue;
+    double score = c.target ? c.Score(get_hp(c.target), max_hps_[c.target.Value()]) : c.Score(0, 0);
+    if (best == -1 || score > best_score) {
+      best = i;
+      best_score = score;
+    }
+  }
+  ASSERT(best != -1);
+  return best;
+}
+
+unique_ptr<AIPhasePlan> AISearch::Result() const {
+  vector<AIPhasePlan::Action> actions;
+  vector<bool> reserved(map_size_.x * map_size_.y, false);
+  vector<double> hps;
+  for (uint32_t i = 0; i < sides_.size(); i++) {
+    hps.push_back(sim_.GetHP(UId{i}));
+  }
+
+  // Follow the most visited children as long as the tree goes, then pick greedily
+  uint32_t node = 0;
+  bool in_tree = true;
+  for (uint32_t unit = 0; unit < units_.size(); unit++) {
+    int pick = -1;
+    if (in_tree && nodes_[node].num_children > 0) {
+      uint32_t best = nodes_[node].first_child;
+      for (uint32_t i = best; i < nodes_[node].first_child + nodes_[node].num_children; i++) {
+        if (nodes_[i].visits > nodes_[best].visits) best = i;
+      }
+      node = best;
+      pick = nodes_[node].pick;
+    } else {
+      in_tree = false;
+      pick = PickGreedy(unit, reserved, [&](const UId& uid) { return static_cast<int>(hps[uid.Value()]); });
+    }
+
+    const UtilityCandidate& c = candidates_[unit][pick];
+    reserved[CellIndex(c.pos)] = true;
+    if (c.kind == UtilityCandidate::Kind::kDamage) {
+      hps[c.target.Value()] -= c.dealt;
+    } else if (c.kind == UtilityCandidate::Kind::kHeal) {
+      hps[c.target.Value()] += c.hit * c.amount;
+    }
+    actions.push_back({units_[unit], c});
+  }
+  return std::make_unique<AIPhasePlan>(stage_, std::move(actions));
+}
+
+// AISearchTask
+
+AISearchTask::AISearchTask(Stage* stage, int budget_ms)
+    : search_(stage), revision_(stage->revision()), done_(false), worker_([this, budget_ms]() {
+        search_.Search(budget_ms);
+        done_ = true;
+      }) {}
+
+AISearchTask::~AISearchTask() {
+  search_.Stop();
+  if (worker_.joinable()) worker_.join();
+}
+
+unique_ptr<AIPhasePlan> AISearchTask::Finish() {
+  if (worker_.joinable()) worker_.join();
+  LOG_INFO("AISearch finished with %u iterations", search_.iterations());
+  return search_.Result();
+}
+
+}  // namespace core
+}  // namespace mengde
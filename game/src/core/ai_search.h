@@ -0,0 +1,99 @@
+#ifndef MENGDE_CORE_AI_SEARCH_H_
+#define MENGDE_CORE_AI_SEARCH_H_
+
+#include <atomic>
+#include <limits>
+#include <thread>
+
+#include "ai_phase_plan.h"
+#include "combat_sim.h"
+#include "utility_scorer.h"
+
+namespace mengde {
+namespace core {
+
+class Stage;
+
+// AISearch plans the whole phase of the current force with Monte Carlo tree search
+//
+// Units pick their actions one after another in a fixed order, strongest single action first, so a path from the
+// root of the tree is a plan for the first units and each level branches over the best candidates of the next unit.
+// An iteration walks down the tree by UCB1, plays the rest of the units greedily and resolves every action on a copy
+// of CombatSim with its own dice rolls. The reward is the HP dealt and taken with bonuses for kills, in the same units
+// as UtilityCandidate::Score, so lucky and unlucky rolls average out over the visits of a node.
+//
+// It is an anytime search. The candidates and the state that actions change are copied on construction, but CombatSim
+// still reads attack ranges and magic effects from the units and terrain from the map, so the stage must not change
+// while `Search` runs. It can run on any thread for as long as it is given or up to a number of iterations, can be
+// called again to continue with the same tree, and `Stop` makes it return early from another thread. `Result` is the
+// most visited path, completed greedily with expected HP like AIPlanner, so it is always a full plan even if no
+// iteration has run. CmdPlayAI plays it one action at a time as an AIPhasePlan, and searches again only when the
+// stage changed in ways the plan could not foresee.
+
+class AISearch {
+ public:
+  AISearch(Stage* stage);
+  void Search(int budget_ms, uint32_t max_iterations = std::numeric_limits<uint32_t>::max());
+  void Stop() { stop_ = true; }
+  // Must be called while the stage is as it was on construction
+  unique_ptr<AIPhasePlan> Result() const;
+  uint32_t iterations() const { return iterations_; }
+
+ private:
+  struct Node {
+    uint32_t pick;         // Candidate index for the unit of the parent's depth
+    uint32_t first_child;  // 0 if not expanded yet, which can not be a child since it is the root
+    uint32_t num_children;
+    uint32_t visits;
+    double total;  // Sum of the rewards
+  };
+
+  void Iterate();
+  bool Expand(uint32_t node, uint32_t depth, const vector<bool>& reserved);
+  uint32_t SelectChild(const Node& node) const;
+  double Play(uint32_t unit, const UtilityCandidate& c, CombatSim* sim, vector<bool>* reserved);
+  int PickGreedy(uint32_t unit, const vector<bool>& reserved, const std::function<int(const UId&)>& get_hp) const;
+  int CellIndex(Vec2D pos) const { return pos.y * map_size_.x + pos.x; }
+
+ private:
+  const Stage* stage_;
+  Vec2D map_size_;
+  vector<UId> units_;                            // In the order to play
+  vector<vector<UtilityCandidate>> candidates_;  // For each unit, the best ones only
+  vector<int> sides_;                            // Indexed by UId, 1 for hostile, -1 for friendly and 0 for dead
+  vector<int> max_hps_;                          // Indexed by UId
+  CombatSim sim_;
+  Rng rng_;
+  vector<Node> nodes_;
+  double min_reward_;
+  double max_reward_;
+  uint32_t iterations_;
+  std::atomic<bool> stop_;
+};
+
+// AISearchTask runs an AISearch on a worker thread
+//
+// The search is prepared on the calling thread. The worker reads the units and the map of the stage as the search goes,
+// so nothing may change the stage until the task is finished or destroyed, which is why StateUIThinking does no Cmd
+// while it waits.
+// `revision` is the stage revision it was started at, so a result for an outdated stage can be told apart.
+
+class AISearchTask {
+ public:
+  AISearchTask(Stage* stage, int budget_ms);
+  ~AISearchTask();
+  bool IsDone() const { return done_; }
+  uint32_t revision() const { return revision_; }
+  unique_ptr<AIPhasePlan> Finish();
+
+ private:
+  AISearch search_;
+  uint32_t revision_;
+  std::atomic<bool> done_;
+  std::thread worker_;
+};
+
+}  // namespace core
+}  // namespace mengde
+
+#endif  // MENGDE_CORE_AI_SEARCH_H_
@@ -1,10 +1,34 @@
 #include "ai_unit.h"
 
+#include "ai_decision_cache.h"
+#include "magic.h"
+#include "unit.h"
 #include "user_interface.h"
+#include "util/rng.h"
+#include "utility_scorer.h"
 
 namespace mengde {
 namespace core {
 
+namespace {
+
+// The farthest an attack of the unit goes, in Manhattan distance
+int AttackReach(const Unit* unit) {
+  int reach = 0;
+  unit->attack_range().ForEach([&](Vec2D d) { reach = std::max(reach, std::abs(d.x) + std::abs(d.y)); });
+  return reach;
+}
+
+MoveKey FindMove(const AvailableMoves& moves, Vec2D pos) {
+  const vector<Vec2D>& cells = moves.moves();
+  for (uint32_t i = 0; i < cells.size(); i++) {
+    if (cells[i] == pos) return MoveKey{i};
+  }
+  return MoveKey{};
+}
+
+}  // namespace
+
 // AIUnitNone
 
 void AIUnitNone::play(const UnitKey&, UserInterface*) const { throw std::runtime_error("Unreachable"); }
@@ -14,13 +38,13 @@ void AIUnitNone::play(const UnitKey&, UserInterface*) const { throw std::runtime
 void AIUnitRandom::play(const UnitKey& ukey, UserInterface* ui) const {
   AvailableMoves moves = ui->QueryMoves(ukey);
 
-  MoveKey mkey = GenRandom(moves.Count());
+  MoveKey mkey = ui->GetAIRng()->Gen(moves.Count());
 
   AvailableActs acts = ui->QueryActs(ukey, mkey, ActionType::kBasicAttack);
   if (acts.Count() > 0) {
     ui->PushAction(ukey, mkey, ActionType::kBasicAttack, 0 /* Simply choose first one */);
   } else {
-    ui->PushAction(ukey, GenRandom(moves.Count()), ActionType::kStay, 0);
+    ui->PushAction(ukey, ui->GetAIRng()->Gen(moves.Count()), ActionType::kStay, 0);
   }
 }
 
@@ -34,21 +58,46 @@ void AIUnitDoNothing::play(const UnitKey& ukey, UserInterface* ui) const {
 
 void AIUnitUnitInRangeRandom::play(const UnitKey& ukey, UserInterface* ui) const {
   AvailableMoves moves = ui->QueryMoves(ukey);
+  const Unit* unit = ui->GetUnit(ukey);
+  const Vec2D pos = unit->position();
+
+  // The decision depends on what an attack reaches from the movement range, and on ZOC right beyond the range
+  AIDecisionCache* cache = ui->GetAIDecisionCache();
+  const uint64_t key = cache->Key(unit, AIMode::kUnitInRangeRandom, unit->move() + std::max(AttackReach(unit), 1));
+  AIDecisionCache::Decision decision;
+  if (cache->Find(key, &decision)) {
+    if (decision.type == ActionType::kStay) {  // No target anywhere, still rolls the dice as below
+      ui->PushAction(ukey, ui->GetAIRng()->Gen(moves.Count()), ActionType::kStay, 0);
+      return;
+    }
+    const MoveKey mkey = FindMove(moves, pos + decision.move);
+    ActKey akey{};
+    if (mkey) akey = ui->QueryActs(ukey, mkey, ActionType::kBasicAttack).Find(pos + decision.target);
+    if (akey) {
+      ui->PushAction(ukey, mkey, ActionType::kBasicAttack, akey);
+      return;
+    }
+    cache->Remove(key);
+  }
 
   bool found_target = false;
   MoveKey mkey = 0;
+  Vec2D target_pos;
   moves.ForEach([&](const MoveKey& mk, Vec2D) {
     AvailableActs acts = ui->QueryActs(ukey, mk, ActionType::kBasicAttack);
     if (acts.Count() > 0 && !found_target) {
       found_target = true;
       mkey = mk;
+      target_pos = acts.GetTargetPos(0);
     }
   });
 
   if (found_target) {
+    cache->Insert(key, {moves.Get(mkey) - pos, ActionType::kBasicAttack, target_pos - pos});
     ui->PushAction(ukey, mkey, ActionType::kBasicAttack, 0 /* Simply choose first one */);
   } else {
-    ui->PushAction(ukey, GenRandom(moves.Count()), ActionType::kStay, 0);
+    cache->Insert(key, {{0, 0}, ActionType::kStay, {0, 0}});
+    ui->PushAction(ukey, ui->GetAIRng()->Gen(moves.Count()), ActionType::kStay, 0);
   }
 }
 
@@ -65,5 +114,42 @@ void AIUnitHoldPosition::play(const UnitKey& ukey, UserInterface* ui) const {
   }
 }
 
+// AIUnitUtility
+
+void AIUnitUtility::play(const UnitKey& ukey, UserInterface* ui) const {
+  AvailableMoves moves = ui->QueryMoves(ukey);
+  const Unit* unit = ui->GetUnit(ukey);
+
+  UtilityScorer scorer(ui, unit->force());
+  vector<UtilityCandidate> candidates = scorer.Evaluate(unit, moves);
+
+  // Ties go to the first candidate so the result does not depend on the scheduling
+  const UtilityCandidate* best = nullptr;
+  double best_score = 0.0;
+  for (const UtilityCandidate& c : candidates) {
+    const Unit* target = c.target ? ui->GetUnit(c.target) : nullptr;
+    double score = target ? c.Score(target->GetCurrentHpMp().hp, target->GetOriginalHpMp().hp) : c.Score(0, 0);
+    if (best == nullptr || score > best_score) {
+      best = &c;
+      best_score = score;
+    }
+  }
+  ASSERT(best != nullptr);
+  const MoveKey mkey{best->move};
+
+  ActKey akey{};
+  if (best->type == ActionType::kBasicAttack) {
+    akey = ui->QueryActs(ukey, mkey, ActionType::kBasicAttack).Find(best->target_pos);
+  } else if (best->type == ActionType::kMagic) {
+    akey = ui->QueryActs(ukey, mkey, ActionType::kMagic).FindMagic(best->magic->GetId(), best->target_pos);
+  }
+
+  if (akey) {
+    ui->PushAction(ukey, mkey, best->type, akey);
+  } else {
+    ui->PushAction(ukey, mkey, ActionType::kStay, 0);
+  }
+}
+
 }  // namespace core
 }  // namespace mengde
@@ -37,6 +37,13 @@ class AIUnitHoldPosition : public IAIUnit {
   virtual void play(const UnitKey& unit_key, UserInterface* ui) const override;
 };
 
+// AIUnitUtility scores every (move, action, target) combination with UtilityScorer and plays the best one
+
+class AIUnitUtility : public IAIUnit {
+ public:
+  virtual void play(const UnitKey& unit_key, UserInterface* ui) const override;
+};
+
 }  // namespace core
 }  // namespace mengde
 
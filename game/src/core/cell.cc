@@ -3,15 +3,15 @@
 namespace mengde {
 namespace core {
 
-Cell::Cell(Terrain* terrain) : terrain_(terrain) {}
+Cell::Cell(Terrain* terrain, const UId* uid) : terrain_(terrain), uid_(uid) {}
 
-Terrain* Cell::GetTerrain() { return terrain_; }
+Terrain* Cell::GetTerrain() const { return terrain_; }
 
-int Cell::GetMoveCost(int class_idx) { return terrain_->GetMoveCost(class_idx); }
+int Cell::GetMoveCost(int class_idx) const { return terrain_->GetMoveCost(class_idx); }
 
 int Cell::GetTerrainEffect(int class_idx) const { return terrain_->GetEffect(class_idx); }
 
-int Cell::ApplyTerrainEffect(int class_idx, int value) { return value * terrain_->GetEffect(class_idx) / 100; }
+int Cell::ApplyTerrainEffect(int class_idx, int value) const { return value * terrain_->GetEffect(class_idx) / 100; }
 
 std::string Cell::GetTerrainId() const { return terrain_->id(); }
 
@@ -10,22 +10,24 @@
 namespace mengde {
 namespace core {
 
+// Cell is a read-only view of a cell of Map
+//
+// The map data itself lives in flat arrays of Map, a Cell only refers to its terrain and its slot of the unit array.
+
 class Cell {
  public:
-  Cell(Terrain*);
-  Terrain* GetTerrain();
-  int GetMoveCost(int);
+  Cell(Terrain*, const UId*);
+  Terrain* GetTerrain() const;
+  int GetMoveCost(int) const;
   int GetTerrainEffect(int) const;
-  int ApplyTerrainEffect(int, int);
+  int ApplyTerrainEffect(int, int) const;
   std::string GetTerrainId() const;
-  bool IsUnitPlaced() const { return !uid_.IsNone(); }
-  UId GetUnit() const { return uid_; }
-  void SetUnit(const UId& uid) { uid_ = uid; }
-  void Empty() { uid_.SetNone(); }
+  bool IsUnitPlaced() const { return !uid_->IsNone(); }
+  UId GetUnit() const { return *uid_; }
 
  private:
   Terrain* terrain_;
-  UId uid_;
+  const UId* uid_;
 };
 
 }  // namespace core
@@ -3,6 +3,7 @@
 
 #include <boost/optional.hpp>
 
+#include "cmd_pool.h"
 #include "id.h"
 #include "unit.h"
 #include "util/common.h"
@@ -19,20 +20,32 @@ extern const char* kCmdOpToString[];
 
 class Cmd {
  public:
-  enum class Op {
+  enum class Op : uint8_t {
     kCmdInvalid,
 #define MACRO_CMD_OP(name) kCmd##name,
 #include "cmd_op.h.inc"
   };
 
  public:
+  Cmd(Op op) : op_(op) {}
   virtual ~Cmd() = default;
   virtual unique_ptr<Cmd> Do(Stage*) = 0;
-  // virtual Cmd* Undo(Stage*) = 0;
-  virtual Cmd::Op op() const = 0;
+  Cmd::Op op() const { return op_; }
+
+  // Same as `Do`, but dispatched with a switch on `op()` so the command pipeline makes no virtual calls and each `Do`
+  // can be inlined into it. Replays measure the same with either, as a Cmd costs far more than its call.
+  unique_ptr<Cmd> Dispatch(Stage*);
 
  public:
   virtual void Accept(CmdVisitor& visitor) const = 0;
+
+ public:
+  // Cmds are made and dropped for every action, so they are kept in CmdPool
+  static void* operator new(size_t size) { return CmdPool::Allocate(size); }
+  static void operator delete(void* p, size_t size) { CmdPool::Release(p, size); }
+
+ private:
+  Op op_;  // The tag every Cmd carries, so its type is told without RTTI
 };
 
 }  // namespace core
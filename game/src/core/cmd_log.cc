@@ -0,0 +1,292 @@
+#include "cmd_log.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "cmds.h"
+#include "magic.h"
+#include "stage.h"
+
+namespace mengde {
+namespace core {
+
+namespace {
+
+const char kMagic[] = {'M', 'D', 'C', 'L'};
+
+class Writer {
+ public:
+  Writer(string* out) : out_(out) {}
+  void U8(uint8_t v) { out_->push_back(static_cast<char>(v)); }
+  void Fixed(uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; i++) U8(static_cast<uint8_t>(v >> (8 * i)));
+  }
+  void Var(uint64_t v) {
+    while (v >= 0x80) {
+      U8(static_cast<uint8_t>(v | 0x80));
+      v >>= 7;
+    }
+    U8(static_cast<uint8_t>(v));
+  }
+  void Str(const string& s) {
+    Var(s.size());
+    out_->append(s);
+  }
+  // None is 0, so a UId takes a byte for the first 127 units
+  void Unit(const UId& uid) { Var(uid ? uid.Value() + 1ull : 0ull); }
+
+ private:
+  string* out_;
+};
+
+// Every read fails once the data runs out, so it is enough to check `ok()` at the end
+class Reader {
+ public:
+  Reader(const string& data) : data_(data), pos_(0), ok_(true) {}
+  bool ok() const { return ok_; }
+  bool AtEnd() const { return pos_ == data_.size(); }
+  uint8_t U8() {
+    if (pos_ >= data_.size()) {
+      ok_ = false;
+      return 0;
+    }
+    return static_cast<uint8_t>(data_[pos_++]);
+  }
+  uint64_t Fixed(int bytes) {
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; i++) v |= static_cast<uint64_t>(U8()) << (8 * i);
+    return v;
+  }
+  uint64_t Var() {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      const uint8_t b = U8();
+      v |= static_cast<uint64_t>(b & 0x7f) << shift;
+      if (!(b & 0x80)) return v;
+    }
+    ok_ = false;
+    return 0;
+  }
+  string Str() {
+    const uint64_t size = Var();
+    if (!ok_ || size > data_.size() - pos_) {
+      ok_ = false;
+      return string();
+    }
+    string s = data_.substr(pos_, size);
+    pos_ += size;
+    return s;
+  }
+  UId Unit() {
+    const uint64_t v = Var();
+    return v ? UId{static_cast<uint32_t>(v - 1)} : UId{};
+  }
+
+ private:
+  const string& data_;
+  size_t pos_;
+  bool ok_;
+};
+
+bool IsUnit(Stage* stage, const UId& uid) {
+  uint32_t num_units = 0;
+  stage->ForEachUnitConst([&num_units](const Unit*) { num_units++; });
+  return uid && uid.Value() < num_units;
+}
+
+// Either one of kActive or kCounter, as CmdBasicAttack asserts, and nothing but kSecond besides
+bool IsValidType(CmdBasicAttack::Type type) {
+  const int active_or_counter = type & CmdBasicAttack::Type::kActiveOrCounter;
+  return (type & ~(CmdBasicAttack::Type::kActiveOrCounter | CmdBasicAttack::Type::kSecond)) == 0 &&
+         active_or_counter != 0 && active_or_counter != CmdBasicAttack::Type::kActiveOrCounter;
+}
+
+unique_ptr<CmdAct> DecodeAct(Reader* r, Stage* stage) {
+  const Cmd::Op op = static_cast<Cmd::Op>(r->U8());
+  const UId atk = r->Unit();
+  const UId def = r->Unit();
+  if (!r->ok() || !IsUnit(stage, atk)) return nullptr;
+  switch (op) {
+    case Cmd::Op::kCmdStay:
+      return std::make_unique<CmdStay>(atk);
+    case Cmd::Op::kCmdBasicAttack: {
+      const auto type = static_cast<CmdBasicAttack::Type>(r->U8());
+      if (!r->ok() || !IsUnit(stage, def) || !IsValidType(type)) return nullptr;
+      return std::make_unique<CmdBasicAttack>(atk, def, type);
+    }
+    case Cmd::Op::kCmdMagic: {
+      const string magic_id = r->Str();
+      if (!r->ok() || !IsUnit(stage, def) || !stage->magic_manager()->Has(magic_id)) return nullptr;
+      return std::make_unique<CmdMagic>(atk, def, stage->LookupMagic(magic_id));
+    }
+    default:
+      return nullptr;
+  }
+}
+
+}  // namespace
+
+const uint16_t CmdLog::kVersion;
+
+CmdLog::CmdLog() : seed_(0), num_done_(0) {}
+
+CmdLog::CmdLog(uint64_t seed, const string& scenario_id) : seed_(seed), scenario_id_(scenario_id), num_done_(0) {}
+
+bool CmdLog::Append(Kind kind, uint32_t count, const Cmd* cmd) {
+  Entry entry{kind, count, string()};
+  if (cmd != nullptr && !EncodeCmd(*cmd, &entry.cmd)) {
+    LOG_WARNING("Cmd '%s' cannot be written to CmdLog", kCmdOpToString[static_cast<uint32_t>(cmd->op())]);
+    return false;
+  }
+  entries_.push_back(std::move(entry));
+  return true;
+}
+
+bool CmdLog::Save(const string& path) const {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  const string data = Serialize();
+  file.write(data.data(), data.size());
+  return file.good();
+}
+
+bool CmdLog::Load(const string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return false;
+  std::ostringstream data;
+  data << file.rdbuf();
+  return Deserialize(data.str());
+}
+
+string CmdLog::Serialize() const {
+  string data(kMagic, sizeof(kMagic));
+  Writer w(&data);
+  w.Fixed(kVersion, 2);
+  w.Fixed(seed_, 8);
+  w.Str(scenario_id_);
+  w.Var(deploys_.size());
+  for (const Deploy& deploy : deploys_) {
+    w.Var(deploy.no);
+    w.Str(deploy.hero_id);
+  }
+  w.Var(num_done_);
+  // Counts are written as the difference to the previous entry's, which is mostly 0 or 1
+  uint32_t count = 0;
+  for (const Entry& entry : entries_) {
+    w.U8(static_cast<uint8_t>(entry.kind));
+    w.Var(entry.count - count);
+    w.Str(entry.cmd);
+    count = entry.count;
+  }
+  return data;
+}
+
+bool CmdLog::Deserialize(const string& data) {
+  if (data.compare(0, sizeof(kMagic), kMagic, sizeof(kMagic)) != 0) return false;
+  Reader r(data);
+  for (size_t i = 0; i < sizeof(kMagic); i++) r.U8();
+  if (r.Fixed(2) != kVersion) return false;
+  seed_ = r.Fixed(8);
+  scenario_id_ = r.Str();
+  deploys_.clear();
+  for (uint64_t i = 0, size = r.Var(); r.ok() && i < size; i++) {
+    const uint32_t no = r.Var();
+    deploys_.push_back({no, r.Str()});
+  }
+  num_done_ = r.Var();
+  entries_.clear();
+  uint32_t count = 0;
+  while (r.ok() && !r.AtEnd()) {
+    const uint8_t kind = r.U8();
+    count += r.Var();
+    if (kind > static_cast<uint8_t>(Kind::kRedo)) return false;
+    entries_.push_back({static_cast<Kind>(kind), count, r.Str()});
+  }
+  return r.ok();
+}
+
+bool CmdLog::EncodeCmd(const Cmd& cmd, string* out) {
+  Writer w(out);
+  switch (cmd.op()) {
+    case Cmd::Op::kCmdAction: {
+      const CmdAction& action = static_cast<const CmdAction&>(cmd);
+      const CmdMove* move = action.cmd_move();
+      const CmdAct* act = action.cmd_act();
+      w.U8(static_cast<uint8_t>(cmd.op()));
+      w.U8(static_cast<uint8_t>(action.flag()));
+      w.U8((move != nullptr ? 1 : 0) | (act != nullptr ? 2 : 0));
+      if (move != nullptr) {
+        w.Unit(move->GetUnit());
+        w.Var(static_cast<uint32_t>(move->GetDest().x));
+        w.Var(static_cast<uint32_t>(move->GetDest().y));
+      }
+      if (act != nullptr) {
+        w.U8(static_cast<uint8_t>(act->op()));
+        w.Unit(act->GetUnitAtk());
+        w.Unit(act->GetUnitDef());
+        if (act->op() == Cmd::Op::kCmdBasicAttack) {
+          w.U8(static_cast<const CmdBasicAttack*>(act)->type());
+        } else if (act->op() == Cmd::Op::kCmdMagic) {
+          w.Str(static_cast<const CmdMagic*>(act)->magic()->GetId());
+        } else if (act->op() != Cmd::Op::kCmdStay) {
+          return false;
+        }
+      }
+      return true;
+    }
+    case Cmd::Op::kCmdEndTurn:
+      w.U8(static_cast<uint8_t>(cmd.op()));
+      return true;
+    case Cmd::Op::kCmdPlayAI:
+      w.U8(static_cast<uint8_t>(cmd.op()));
+      w.U8(static_cast<uint8_t>(static_cast<const CmdPlayAI&>(cmd).mode()));
+      return true;
+    default:
+      return false;
+  }
+}
+
+unique_ptr<Cmd> CmdLog::DecodeCmd(const string& data, Stage* stage) {
+  Reader r(data);
+  unique_ptr<Cmd> cmd;
+  switch (static_cast<Cmd::Op>(r.U8())) {
+    case Cmd::Op::kCmdAction: {
+      const uint8_t flag = r.U8();
+      const uint8_t parts = r.U8();
+      if (flag == static_cast<uint8_t>(CmdAction::Flag::kNone) ||
+          flag > static_cast<uint8_t>(CmdAction::Flag::kDecompose)) {
+        return nullptr;
+      }
+      auto action = std::make_unique<CmdAction>(static_cast<CmdAction::Flag>(flag));
+      if (parts & 1) {
+        const UId uid = r.Unit();
+        const int x = static_cast<int32_t>(r.Var());
+        const int y = static_cast<int32_t>(r.Var());
+        if (!r.ok() || !IsUnit(stage, uid) || !stage->IsValidCoords(Vec2D{x, y})) return nullptr;
+        action->SetCmdMove(std::make_unique<CmdMove>(uid, Vec2D{x, y}));
+      }
+      if (parts & 2) {
+        unique_ptr<CmdAct> act = DecodeAct(&r, stage);
+        if (act == nullptr) return nullptr;
+        action->SetCmdAct(std::move(act));
+      }
+      if (parts == 0) return nullptr;
+      cmd = std::move(action);
+      break;
+    }
+    case Cmd::Op::kCmdEndTurn:
+      cmd = std::make_unique<CmdEndTurn>();
+      break;
+    case Cmd::Op::kCmdPlayAI: {
+      const uint8_t mode = r.U8();
+      if (mode > static_cast<uint8_t>(CmdPlayAI::Mode::kReplay)) return nullptr;
+      cmd = std::make_unique<CmdPlayAI>(static_cast<CmdPlayAI::Mode>(mode));
+      break;
+    }
+    default:
+      return nullptr;
+  }
+  return (r.ok() && r.AtEnd()) ? std::move(cmd) : nullptr;
+}
+
+}  // namespace core
+}  // namespace mengde
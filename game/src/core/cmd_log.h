@@ -0,0 +1,81 @@
+#ifndef MENGDE_CORE_CMD_LOG_H_
+#define MENGDE_CORE_CMD_LOG_H_
+
+#include "util/common.h"
+
+namespace mengde {
+namespace core {
+
+class Cmd;
+class Stage;
+
+// CmdLog is a compact binary log of what decided the course of a stage, so that it can be played again
+//
+// It starts with the seed of the stage, the heroes deployed and how many Cmds were done in all, followed by entries
+// that each tell how many Cmds had been done before it. Everything else follows from these, as the stage draws every
+// random number from its own Rng and the Lua script does the same for the same state. Only the Cmds that are decisions
+// can be written, which are CmdAction, CmdEndTurn and CmdPlayAI.
+//
+// The format is a header of the magic "MDCL", a 16-bit version, the seed, the scenario id, the deploys and the number
+// of Cmds done, then the entries. Integers but the version and the seed are LEB128 varints, and strings are a length
+// then the bytes.
+
+class CmdLog {
+ public:
+  enum class Kind : uint8_t {
+    kInput,     // Pushed by the user or a frontend while no Cmd is done
+    kAIPush,    // Pushed by an AI while a CmdPlayAI is done
+    kAIResult,  // Returned by a CmdPlayAI, one entry for each Cmd when it returns several
+    kUndo,      // Stage::Undo, with no Cmd
+    kRedo       // Stage::Redo, with no Cmd
+  };
+
+  struct Deploy {
+    uint32_t no;
+    string hero_id;
+  };
+
+  struct Entry {
+    Kind kind;
+    uint32_t count;  // Cmds done before
+    string cmd;      // Encoded, empty for kUndo and kRedo
+  };
+
+ public:
+  static const uint16_t kVersion = 1;
+
+ public:
+  CmdLog();
+  CmdLog(uint64_t seed, const string& scenario_id);
+
+  uint64_t seed() const { return seed_; }
+  const string& scenario_id() const { return scenario_id_; }
+  const vector<Deploy>& deploys() const { return deploys_; }
+  const vector<Entry>& entries() const { return entries_; }
+  uint32_t num_done() const { return num_done_; }
+  void AddDeploy(uint32_t no, const string& hero_id) { deploys_.push_back({no, hero_id}); }
+  void set_num_done(uint32_t num_done) { num_done_ = num_done; }
+  bool Append(Kind kind, uint32_t count, const Cmd* cmd);
+
+  bool Save(const string& path) const;
+  bool Load(const string& path);
+  string Serialize() const;
+  bool Deserialize(const string& data);
+
+  // Returns false if the Cmd is not one that can be written
+  static bool EncodeCmd(const Cmd& cmd, string* out);
+  // Returns nullptr if the data is malformed, or names a unit, a cell or a magic that does not exist
+  static unique_ptr<Cmd> DecodeCmd(const string& data, Stage* stage);
+
+ private:
+  uint64_t seed_;
+  string scenario_id_;
+  vector<Deploy> deploys_;
+  vector<Entry> entries_;
+  uint32_t num_done_;  // Cmds done while recorded, as the queue may not be empty at the end
+};
+
+}  // namespace core
+}  // namespace mengde
+
+#endif  // MENGDE_CORE_CMD_LOG_H_
@@ -0,0 +1,154 @@
+#include "cmd_pool.h"
+
+#include <atomic>
+#include <mutex>
+#include <new>
+
+#include "util/common.h"
+
+#if defined(__SANITIZE_ADDRESS__)
+#define CMD_POOL_DISABLED
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define CMD_POOL_DISABLED
+#endif
+#endif
+
+namespace mengde {
+namespace core {
+
+namespace {
+
+const size_t kGranularity = 16;
+const size_t kMaxBlockSize = 512;
+const size_t kNumClasses = kMaxBlockSize / kGranularity;
+const size_t kChunkSize = 16 * 1024;
+
+struct Block {
+  Block* next;
+};
+
+std::atomic<uint64_t> chunk_count{0};
+std::atomic<uint64_t> large_count{0};
+
+// Free blocks handed over by threads that ended
+struct Depot {
+  std::mutex mutex;
+  Block* free[kNumClasses] = {};
+};
+
+Depot* GetDepot() {
+  static Depot* depot = new Depot;  // Never destroyed, as Cmds may still be released while statics are destroyed
+  return depot;
+}
+
+void Push(Block** list, void* p) {
+  Block* block = static_cast<Block*>(p);
+  block->next = *list;
+  *list = block;
+}
+
+void* Pop(Block** list) {
+  Block* block = *list;
+  *list = block->next;
+  return block;
+}
+
+// Set once the pool of the thread is destroyed, from then on the thread goes to the depot. Being trivially
+// destructible, it is still there while the other thread_local objects of the thread are destroyed.
+thread_local bool pool_destroyed = false;
+
+class LocalPool {
+ public:
+  ~LocalPool() {
+    Depot* depot = GetDepot();
+    std::lock_guard<std::mutex> lock(depot->mutex);
+    for (size_t c = 0; c < kNumClasses; c++) {
+      while (free_[c] != nullptr) Push(&depot->free[c], Pop(&free_[c]));
+    }
+    pool_destroyed = true;
+  }
+
+  void* Allocate(size_t c) {
+    if (free_[c] == nullptr) Refill(c);
+    num_allocations_++;
+    return Pop(&free_[c]);
+  }
+
+  void Release(void* block, size_t c) { Push(&free_[c], block); }
+  uint64_t num_allocations() const { return num_allocations_; }
+
+ private:
+  void Refill(size_t c) {
+    Depot* depot = GetDepot();
+    {
+      std::lock_guard<std::mutex> lock(depot->mutex);
+      if (depot->free[c] != nullptr) {
+        std::swap(free_[c], depot->free[c]);
+        return;
+      }
+    }
+    const size_t size = (c + 1) * kGranularity;
+    char* chunk = static_cast<char*>(::operator new(kChunkSize));
+    chunk_count++;
+    for (size_t offset = 0; offset + size <= kChunkSize; offset += size) {
+      Push(&free_[c], chunk + offset);
+    }
+  }
+
+ private:
+  Block* free_[kNumClasses] = {};
+  uint64_t num_allocations_ = 0;
+};
+
+thread_local LocalPool local_pool;
+
+size_t SizeClass(size_t size) { return (size - 1) / kGranularity; }
+
+}  // namespace
+
+void* CmdPool::Allocate(size_t size) {
+#ifndef CMD_POOL_DISABLED
+  if (size <= kMaxBlockSize) {
+    const size_t c = SizeClass(size);
+    if (!pool_destroyed) return local_pool.Allocate(c);
+
+    Depot* depot = GetDepot();
+    std::lock_guard<std::mutex> lock(depot->mutex);
+    if (depot->free[c] != nullptr) return Pop(&depot->free[c]);
+    return ::operator new((c + 1) * kGranularity);  // A block of the class, as it is released to the depot
+  }
+#endif
+  large_count++;
+  return ::operator new(size);
+}
+
+void CmdPool::Release(void* block, size_t size) {
+  if (block == nullptr) return;
+#ifndef CMD_POOL_DISABLED
+  if (size <= kMaxBlockSize) {
+    const size_t c = SizeClass(size);
+    if (!pool_destroyed) {
+      local_pool.Release(block, c);
+      return;
+    }
+
+    Depot* depot = GetDepot();
+    std::lock_guard<std::mutex> lock(depot->mutex);
+    Push(&depot->free[c], block);
+    return;
+  }
+#else
+  UNUSED(size);
+#endif
+  ::operator delete(block);
+}
+
+uint64_t CmdPool::num_allocations() { return pool_destroyed ? 0 : local_pool.num_allocations(); }
+
+uint64_t CmdPool::num_chunks() { return chunk_count; }
+
+uint64_t CmdPool::num_large() { return large_count; }
+
+}  // namespace core
+}  // namespace mengde
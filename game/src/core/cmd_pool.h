@@ -0,0 +1,61 @@
+#ifndef MENGDE_CORE_CMD_POOL_H_
+#define MENGDE_CORE_CMD_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace mengde {
+namespace core {
+
+// CmdPool is where Cmds and the deques of CmdQueue get their memory
+//
+// Blocks are kept in free lists by size class, 16 bytes apart up to 512 bytes, and carved out of 16KB chunks taken
+// from the system when a free list runs dry. A released block goes back to its free list, so once a game is running
+// the command pipeline reuses the same blocks and stops allocating. Larger blocks are passed on to the system.
+//
+// Free lists are per thread, so the games of a batch simulation, each on its own thread, do not contend for them. A
+// block may be released by another thread than the one that allocated it, and the free blocks of a thread are handed
+// to the other threads when it ends. Chunks are never given back to the system.
+//
+// With AddressSanitizer every block comes from the system, so use-after-free of a Cmd is still caught.
+
+class CmdPool {
+ public:
+  static void* Allocate(size_t size);
+  static void Release(void* block, size_t size);
+  static uint64_t num_allocations();  // Blocks handed out to the calling thread
+  static uint64_t num_chunks();       // Chunks taken from the system, by all threads
+  static uint64_t num_large();        // Blocks too large for the pool, by all threads
+
+ private:
+  CmdPool();  // Prevent instantiation
+};
+
+// CmdPoolAllocator is a standard allocator on CmdPool, for containers of the command pipeline
+
+template <typename T>
+class CmdPoolAllocator {
+ public:
+  using value_type = T;
+
+  CmdPoolAllocator() = default;
+  template <typename U>
+  CmdPoolAllocator(const CmdPoolAllocator<U>&) {}
+
+  T* allocate(size_t n) { return static_cast<T*>(CmdPool::Allocate(n * sizeof(T))); }
+  void deallocate(T* p, size_t n) { CmdPool::Release(p, n * sizeof(T)); }
+
+  template <typename U>
+  bool operator==(const CmdPoolAllocator<U>&) const {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const CmdPoolAllocator<U>&) const {
+    return false;
+  }
+};
+
+}  // namespace core
+}  // namespace mengde
+
+#endif  // MENGDE_CORE_CMD_POOL_H_
@@ -24,9 +24,9 @@ unique_ptr<Cmd> CmdQueue::Do(Stage* game) {
   q_.pop_front();
 
   // Nested CmdQueue is not allowed
-  ASSERT(dynamic_cast<CmdQueue*>(current.get()) == nullptr);
+  ASSERT(current->op() != Op::kCmdQueue);
 
-  unique_ptr<Cmd> result = current->Do(game);
+  unique_ptr<Cmd> result = current->Dispatch(game);
   if (result != nullptr) {
     Prepend(std::move(result));
   }
@@ -53,7 +53,8 @@ unique_ptr<Cmd> CmdQueue::Do(Stage* game) {
 
 void CmdQueue::Insert(unique_ptr<Cmd> cmd, bool prepend) {
   if (cmd == nullptr) return;
-  if (CmdQueue* cmdq = dynamic_cast<CmdQueue*>(cmd.get())) {
+  if (cmd->op() == Op::kCmdQueue) {
+    CmdQueue* cmdq = static_cast<CmdQueue*>(cmd.get());
     if (prepend) {
       // In order to keep the sequence of CmdQueue being appended, push to front in reverse order
       for (auto itr = cmdq->q_.rbegin(); itr != cmdq->q_.rend(); itr++) {
@@ -95,6 +96,11 @@ bool CmdQueue::IsEmpty() const {
   */
 }
 
+void CmdQueue::PopFront() {
+  ASSERT(!IsEmpty());
+  q_.pop_front();
+}
+
 const Cmd* CmdQueue::GetNextCmdConst() const {
   ASSERT(!IsEmpty());
 
@@ -8,10 +8,12 @@ namespace core {
 
 class CmdQueue : public Cmd {
  public:
-  CmdQueue() = default;
+  using Queue = deque<unique_ptr<Cmd>, CmdPoolAllocator<unique_ptr<Cmd>>>;
+
+ public:
+  CmdQueue() : Cmd(Op::kCmdQueue) {}
   ~CmdQueue() = default;
   virtual unique_ptr<Cmd> Do(Stage*) override;
-  virtual Cmd::Op op() const override { return Op::kCmdQueue; }
 
  public:
   virtual void Accept(CmdVisitor& visitor) const override;
@@ -20,19 +22,21 @@ class CmdQueue : public Cmd {
   void Prepend(unique_ptr<Cmd>);
   void Append(unique_ptr<Cmd>);
   bool IsEmpty() const;
+  uint32_t Count() const { return q_.size(); }
   const Cmd* GetNextCmdConst() const;
+  void PopFront();
 
   CmdQueue& operator+=(unique_ptr<Cmd>);
 
  public:
-  deque<unique_ptr<Cmd>>::const_iterator begin() const { return q_.begin(); }
-  deque<unique_ptr<Cmd>>::const_iterator end() const { return q_.end(); }
+  Queue::const_iterator begin() const { return q_.begin(); }
+  Queue::const_iterator end() const { return q_.end(); }
 
  private:
   void Insert(unique_ptr<Cmd>, bool prepend);
 
  private:
-  deque<unique_ptr<Cmd>> q_;
+  Queue q_;
 };
 
 }  // namespace core
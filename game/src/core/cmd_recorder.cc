@@ -0,0 +1,60 @@
+#include "cmd_recorder.h"
+
+#include "assets.h"
+#include "cmd_queue.h"
+#include "stage.h"
+
+namespace mengde {
+namespace core {
+
+CmdRecorder::CmdRecorder(Stage* stage, const string& scenario_id)
+    : log_(stage->seed(), scenario_id),
+      num_done_(0),
+      doing_(false),
+      playing_ai_(false),
+      size_before_(0),
+      num_pushed_(0) {
+  ASSERT(stage->GetStatus() != Stage::Status::kDeploying);
+  for (const Hero* hero : stage->assets()->GetHeroes()) {
+    const uint32_t no = stage->FindDeploy(hero);
+    if (no != 0) log_.AddDeploy(no, hero->id());
+  }
+}
+
+void CmdRecorder::OnPush(const Cmd& cmd) {
+  if (!doing_) {
+    log_.Append(CmdLog::Kind::kInput, num_done_, &cmd);
+  } else if (playing_ai_) {
+    num_pushed_++;
+    // CmdQueue pushes it by itself once the game is decided, so it is done again with no entry
+    if (cmd.op() != Cmd::Op::kCmdGameVictory) log_.Append(CmdLog::Kind::kAIPush, num_done_, &cmd);
+  }
+}
+
+void CmdRecorder::OnDoBegin(const CmdQueue& queue) {
+  doing_ = true;
+  playing_ai_ = (queue.GetNextCmdConst()->op() == Cmd::Op::kCmdPlayAI);
+  size_before_ = queue.Count();
+  num_pushed_ = 0;
+}
+
+void CmdRecorder::OnDoEnd(const CmdQueue& queue) {
+  if (playing_ai_) {
+    // The result was put in front of what was left and the pushes went to the back
+    const uint32_t num_results = queue.Count() - (size_before_ - 1) - num_pushed_;
+    auto itr = queue.begin();
+    for (uint32_t i = 0; i < num_results; i++, itr++) {
+      log_.Append(CmdLog::Kind::kAIResult, num_done_, itr->get());
+    }
+  }
+  log_.set_num_done(++num_done_);
+  doing_ = false;
+  playing_ai_ = false;
+}
+
+void CmdRecorder::OnUndo() { log_.Append(CmdLog::Kind::kUndo, num_done_, nullptr); }
+
+void CmdRecorder::OnRedo() { log_.Append(CmdLog::Kind::kRedo, num_done_, nullptr); }
+
+}  // namespace core
+}  // namespace mengde
@@ -0,0 +1,43 @@
+#ifndef MENGDE_CORE_CMD_RECORDER_H_
+#define MENGDE_CORE_CMD_RECORDER_H_
+
+#include "cmd_log.h"
+#include "util/common.h"
+
+namespace mengde {
+namespace core {
+
+class Cmd;
+class CmdQueue;
+class Stage;
+
+// CmdRecorder writes what is pushed to Commander and what AIs decide to a CmdLog
+//
+// It is to be set right after the stage is deployed, before any Cmd is done. Commander tells it about every push,
+// undo and redo, and about every Cmd it does. Pushes while no Cmd is done are inputs. While a CmdPlayAI is done, what
+// it pushes are AI pushes, and the Cmds it returned are the ones in front of the queue after it is done.
+
+class CmdRecorder {
+ public:
+  CmdRecorder(Stage* stage, const string& scenario_id);
+  const CmdLog& log() const { return log_; }
+
+  void OnPush(const Cmd& cmd);
+  void OnDoBegin(const CmdQueue& queue);
+  void OnDoEnd(const CmdQueue& queue);
+  void OnUndo();
+  void OnRedo();
+
+ private:
+  CmdLog log_;
+  uint32_t num_done_;     // Cmds done so far
+  bool doing_;            // A Cmd is being done
+  bool playing_ai_;       // The Cmd being done is CmdPlayAI
+  uint32_t size_before_;  // Of the queue before the CmdPlayAI is done
+  uint32_t num_pushed_;   // While the CmdPlayAI is done
+};
+
+}  // namespace core
+}  // namespace mengde
+
+#endif  // MENGDE_CORE_CMD_RECORDER_H_
@@ -0,0 +1,122 @@
+#include "cmd_replayer.h"
+
+#include <algorithm>
+
+#include "assets.h"
+#include "cmd_log.h"
+#include "cmd_queue.h"
+#include "cmds.h"
+#include "stage.h"
+
+namespace mengde {
+namespace core {
+
+CmdReplayer::CmdReplayer(Stage* stage, const CmdLog* log) : stage_(stage), log_(log), next_(0), num_done_(0) {}
+
+bool CmdReplayer::Replay() {
+  if (!Deploy()) {
+    LOG_ERROR("CmdLog does not fit the deployment of the stage");
+    return false;
+  }
+
+  while (PushInputs()) {
+    if (num_done_ == log_->num_done()) {
+      if (next_ == log_->entries().size()) return true;
+      LOG_ERROR("CmdLog has entries after the last Cmd done");
+      return false;
+    }
+    if (!stage_->HasNext()) {
+      LOG_ERROR("CmdLog has more Cmds done, but there is nothing to do after Cmd #%u", num_done_);
+      return false;
+    }
+    const Cmd* cmd = stage_->GetNextCmdConst();
+    if (cmd->op() == Cmd::Op::kCmdPlayAI) {
+      // Only the CmdPlayAIs of the log are done, with no AI run
+      if (play_ai_.empty() || play_ai_.front() != cmd || !LoadAI(play_ai_.front())) {
+        LOG_ERROR("CmdLog does not tell what AI did for Cmd #%u", num_done_);
+        return false;
+      }
+      play_ai_.pop_front();
+    }
+    stage_->DoNext();
+    num_done_++;
+  }
+  return false;
+}
+
+bool CmdReplayer::Deploy() {
+  if (stage_->GetStatus() != Stage::Status::kDeploying) return false;
+  stage_->Seed(log_->seed());
+
+  vector<CmdLog::Deploy> deploys = log_->deploys();
+  std::stable_sort(deploys.begin(), deploys.end(),
+                   [](const CmdLog::Deploy& lhs, const CmdLog::Deploy& rhs) { return lhs.no < rhs.no; });
+  const vector<const Hero*> heroes = stage_->assets()->GetHeroes();
+  for (const CmdLog::Deploy& deploy : deploys) {
+    auto found = std::find_if(heroes.begin(), heroes.end(),
+                              [&deploy](const Hero* hero) { return hero->id() == deploy.hero_id; });
+    if (found == heroes.end()) return false;
+    // Unselectable ones are already there, and selectable ones get the numbers in order they are assigned
+    if (stage_->FindDeploy(*found) == deploy.no) continue;
+    if (stage_->AssignDeploy(*found) != deploy.no) return false;
+  }
+  return stage_->SubmitDeploy();
+}
+
+bool CmdReplayer::PushInputs() {
+  const vector<CmdLog::Entry>& entries = log_->entries();
+  for (; next_ < entries.size() && entries[next_].count == num_done_; next_++) {
+    const CmdLog::Entry& entry = entries[next_];
+    switch (entry.kind) {
+      case CmdLog::Kind::kInput: {
+        unique_ptr<Cmd> cmd = CmdLog::DecodeCmd(entry.cmd, stage_);
+        if (cmd == nullptr) {
+          LOG_ERROR("CmdLog has a malformed Cmd at entry #%u", next_);
+          return false;
+        }
+        if (cmd->op() == Cmd::Op::kCmdPlayAI) {
+          auto play_ai = std::make_unique<CmdPlayAI>(CmdPlayAI::Mode::kReplay);
+          play_ai_.push_back(play_ai.get());
+          cmd = std::move(play_ai);
+        }
+        stage_->Push(std::move(cmd));
+        break;
+      }
+      case CmdLog::Kind::kUndo:
+        if (!stage_->Undo()) return false;
+        break;
+      case CmdLog::Kind::kRedo:
+        if (!stage_->Redo()) return false;
+        break;
+      default:
+        return true;  // For the CmdPlayAI about to be done
+    }
+  }
+  if (next_ < entries.size() && entries[next_].count < num_done_) {
+    LOG_ERROR("CmdLog has an entry for Cmd #%u after Cmd #%u is done", entries[next_].count, num_done_);
+    return false;
+  }
+  return true;
+}
+
+bool CmdReplayer::LoadAI(CmdPlayAI* cmd) {
+  const vector<CmdLog::Entry>& entries = log_->entries();
+  vector<unique_ptr<Cmd>> pushes;
+  auto results = std::make_unique<CmdQueue>();
+  for (; next_ < entries.size() && entries[next_].count == num_done_; next_++) {
+    const CmdLog::Entry& entry = entries[next_];
+    if (entry.kind != CmdLog::Kind::kAIPush && entry.kind != CmdLog::Kind::kAIResult) return false;
+    unique_ptr<Cmd> decoded = CmdLog::DecodeCmd(entry.cmd, stage_);
+    if (decoded == nullptr) return false;
+    if (entry.kind == CmdLog::Kind::kAIPush) {
+      pushes.push_back(std::move(decoded));
+    } else {
+      *results += std::move(decoded);
+    }
+  }
+  cmd->SetReplay(std::move(pushes), results->IsEmpty() ? nullptr : std::move(results));
+  return true;
+}
+
+}  // namespace core
+}  // namespace mengde
@@ -0,0 +1,45 @@
+#ifndef MENGDE_CORE_CMD_REPLAYER_H_
+#define MENGDE_CORE_CMD_REPLAYER_H_
+
+#include <deque>
+
+#include "util/common.h"
+
+namespace mengde {
+namespace core {
+
+class CmdLog;
+class CmdPlayAI;
+class Stage;
+
+// CmdReplayer plays a stage again from a CmdLog, as fast as Cmds can be done
+//
+// The stage is to be fresh, still being deployed. It is seeded and deployed as it was recorded, then inputs are pushed
+// when as many Cmds are done as when they were recorded. No AI is run, as each CmdPlayAI is replaced with one that
+// does what the log tells it did. It stops after as many Cmds as were done when recorded, leaving the stage as it was
+// at the end of the recording.
+
+class CmdReplayer {
+ public:
+  CmdReplayer(Stage* stage, const CmdLog* log);
+  // Returns false if the log is malformed or does not fit the stage
+  bool Replay();
+  uint32_t num_done() const { return num_done_; }
+
+ private:
+  bool Deploy();
+  bool PushInputs();
+  bool LoadAI(CmdPlayAI* cmd);
+
+ private:
+  Stage* stage_;
+  const CmdLog* log_;
+  uint32_t next_;                   // Entry of the log to be read next
+  uint32_t num_done_;               // Cmds done so far
+  std::deque<CmdPlayAI*> play_ai_;  // Pushed and not done yet, in order
+};
+
+}  // namespace core
+}  // namespace mengde
+
+#endif  // MENGDE_CORE_CMD_REPLAYER_H_
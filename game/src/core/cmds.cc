@@ -3,6 +3,8 @@
 #include <algorithm>
 
 #include "ai_executor.h"
+#include "ai_planner.h"
+#include "ai_search.h"
 #include "cmd_visitor.h"
 #include "core/path_tree.h"
 #include "formulae.h"
@@ -27,13 +29,29 @@ const char* kCmdOpToString[] = {"Invalid",
   void Cmd##name::Accept(CmdVisitor& visitor) const { visitor.Visit(*this); }
 #include "cmd_op.h.inc"
 
+//
+// Dispatch by the op of a Cmd, calling `Do` of the final class directly
+//
+
+unique_ptr<Cmd> Cmd::Dispatch(Stage* stage) {
+  switch (op_) {
+#define MACRO_CMD_OP(name) \
+  case Op::kCmd##name:     \
+    return static_cast<Cmd##name*>(this)->Cmd##name::Do(stage);
+#include "cmd_op.h.inc"
+    default:
+      UNREACHABLE("Invalid Cmd::Op");
+      return nullptr;
+  }
+}
+
 // CmdUnit
 
-CmdUnit::CmdUnit(const UId& unit) : unit_(unit) { ASSERT(unit_); }
+CmdUnit::CmdUnit(Op op, const UId& unit) : Cmd(op), unit_(unit) { ASSERT(unit_); }
 
 // CmdTwoUnits
 
-CmdTwoUnits::CmdTwoUnits(const UId& atk, const UId& def) : atk_(atk), def_(def) {
+CmdTwoUnits::CmdTwoUnits(Op op, const UId& atk, const UId& def) : Cmd(op), atk_(atk), def_(def) {
   ASSERT(atk_);  // def_(second unit) could be none
 }
 
@@ -41,11 +59,11 @@ void CmdTwoUnits::SwapAtkDef() { std::swap(atk_, def_); }
 
 // CmdAct
 
-CmdAct::CmdAct(const UId& atk, const UId& def) : CmdTwoUnits(atk, def) {}
+CmdAct::CmdAct(Op op, const UId& atk, const UId& def) : CmdTwoUnits(op, atk, def) {}
 
 // CmdStay
 
-CmdStay::CmdStay(const UId& unit) : CmdAct(unit, UId{}) {}
+CmdStay::CmdStay(const UId& unit) : CmdAct(Op::kCmdStay, unit, UId{}) {}
 
 unique_ptr<Cmd> CmdStay::Do(Stage*) {
   // Do nothing
@@ -53,7 +71,7 @@ unique_ptr<Cmd> CmdStay::Do(Stage*) {
 }
 
 // CmdEndAction
-CmdEndAction::CmdEndAction(const UId& unit) : CmdUnit(unit) {}
+CmdEndAction::CmdEndAction(const UId& unit) : CmdUnit(Op::kCmdEndAction, unit) {}
 
 unique_ptr<Cmd> CmdEndAction::Do(Stage* game) {
   auto unit = game->LookupUnit(unit_);
@@ -68,7 +86,7 @@ unique_ptr<Cmd> CmdEndAction::Do(Stage* game) {
 // CmdBasicAttack
 
 CmdBasicAttack::CmdBasicAttack(const UId& atk, const UId& def, Type type)
-    : CmdAct(atk, def), type_(type), multiplier_(0), addend_(0) {
+    : CmdAct(Op::kCmdBasicAttack, atk, def), type_(type), multiplier_(0), addend_(0) {
   // Either one of kActive or kCounter must be set
   ASSERT(type & Type::kActiveOrCounter);
   // Cannot set flag kActive and kCounter at the same time
@@ -140,7 +158,7 @@ bool CmdBasicAttack::TryBasicAttack(Stage* stage) {
 
   int chance = Formulae::ComputeBasicAttackAccuracy(atk, def);
   LOG_INFO("Chance of Hit : %d%", chance);
-  return GenRandom(100) < chance;
+  return stage->rng()->Gen(100) < chance;
 }
 
 bool CmdBasicAttack::TryBasicAttackCritical(Stage* stage) {
@@ -149,7 +167,7 @@ bool CmdBasicAttack::TryBasicAttackCritical(Stage* stage) {
 
   int chance = Formulae::ComputeBasicAttackCritical(atk, def);
   LOG_INFO("Chance of Critical : %d%", chance);
-  return GenRandom(100) < chance;
+  return stage->rng()->Gen(100) < chance;
 }
 
 bool CmdBasicAttack::TryBasicAttackDouble(Stage* stage) {
@@ -158,7 +176,7 @@ bool CmdBasicAttack::TryBasicAttackDouble(Stage* stage) {
 
   int chance = Formulae::ComputeBasicAttackDouble(atk, def);
   LOG_INFO("Chance of Double Attack : %d%", chance);
-  return GenRandom(100) < chance;
+  return stage->rng()->Gen(100) < chance;
 }
 
 int CmdBasicAttack::ComputeDamage(Stage* stage, Map* map) {
@@ -174,14 +192,14 @@ int CmdBasicAttack::ComputeDamage(Stage* stage, Map* map) {
 
 // CmdMagic
 
-CmdMagic::CmdMagic(const UId& atk, const UId& def, Magic* magic) : CmdAct(atk, def), magic_(magic) {}
+CmdMagic::CmdMagic(const UId& atk, const UId& def, Magic* magic) : CmdAct(Op::kCmdMagic, atk, def), magic_(magic) {}
 
 unique_ptr<Cmd> CmdMagic::Do(Stage* stage) {
   auto atk = stage->LookupUnit(atk_);
   auto def = stage->LookupUnit(def_);
 
   LOG_INFO("'%s' tries magic '%s' to '%s'", atk->id().c_str(), magic_->GetId().c_str(), def->id().c_str());
-  bool hit = magic_->TryPerform(atk, def);
+  bool hit = magic_->TryPerform(atk, def, stage->rng());
   Cmd* ret = nullptr;
   if (hit) {
     int hp_diff = 0;
@@ -200,20 +218,21 @@ unique_ptr<Cmd> CmdMagic::Do(Stage* stage) {
 
 // CmdActResult
 
-CmdActResult::CmdActResult(const UId& atk, const UId& def, Type type, Magic* magic)
-    : CmdTwoUnits(atk, def), type_(type), magic_(magic) {}
+CmdActResult::CmdActResult(Op op, const UId& atk, const UId& def, Type type, Magic* magic)
+    : CmdTwoUnits(op, atk, def), type_(type), magic_(magic) {}
 
-CmdActResult::CmdActResult(const UId& atk, const UId& def, Type type) : CmdActResult(atk, def, type, nullptr) {
+CmdActResult::CmdActResult(Op op, const UId& atk, const UId& def, Type type)
+    : CmdActResult(op, atk, def, type, nullptr) {
   ASSERT(type == Type::kBasicAttack);
 }
 
 // CmdHit
 
 CmdHit::CmdHit(const UId& atk, const UId& def, Type type, HitType hit_type, Magic* magic, int damage)
-    : CmdActResult(atk, def, type, magic), hit_type_(hit_type), damage_(damage) {}
+    : CmdActResult(Op::kCmdHit, atk, def, type, magic), hit_type_(hit_type), damage_(damage) {}
 
 CmdHit::CmdHit(const UId& atk, const UId& def, Type type, HitType hit_type, int damage)
-    : CmdActResult(atk, def, type), hit_type_(hit_type), damage_(damage) {}
+    : CmdActResult(Op::kCmdHit, atk, def, type), hit_type_(hit_type), damage_(damage) {}
 
 unique_ptr<Cmd> CmdHit::Do(Stage* stage) {
   auto atk = stage->LookupUnit(atk_);
@@ -233,6 +252,10 @@ unique_ptr<Cmd> CmdHit::Do(Stage* stage) {
   } else {
     ASSERT(type_ == Type::kMagic);
     magic_->Perform(atk, def);
+    // Removed from the map like a unit killed by a basic attack, or the AIs would plan moves onto its cell
+    if (def->IsDead()) {
+      ret->Append(std::make_unique<CmdKilled>(def_));
+    }
   }
 
   // Gain experience
@@ -248,9 +271,10 @@ unique_ptr<Cmd> CmdHit::Do(Stage* stage) {
 
 // CmdMiss
 
-CmdMiss::CmdMiss(const UId& atk, const UId& def, Type type, Magic* magic) : CmdActResult(atk, def, type, magic) {}
+CmdMiss::CmdMiss(const UId& atk, const UId& def, Type type, Magic* magic)
+    : CmdActResult(Op::kCmdMiss, atk, def, type, magic) {}
 
-CmdMiss::CmdMiss(const UId& atk, const UId& def, Type type) : CmdActResult(atk, def, type) {}
+CmdMiss::CmdMiss(const UId& atk, const UId& def, Type type) : CmdActResult(Op::kCmdMiss, atk, def, type) {}
 
 unique_ptr<Cmd> CmdMiss::Do(Stage* stage) {
   auto atk = stage->LookupUnit(atk_);
@@ -271,7 +295,7 @@ unique_ptr<Cmd> CmdMiss::Do(Stage* stage) {
 
 // CmdKilled
 
-CmdKilled::CmdKilled(const UId& unit) : CmdUnit(unit) {}
+CmdKilled::CmdKilled(const UId& unit) : CmdUnit(Op::kCmdKilled, unit) {}
 
 unique_ptr<Cmd> CmdKilled::Do(Stage* stage) {
   stage->KillUnit(stage->LookupUnit(unit_));
@@ -280,7 +304,7 @@ unique_ptr<Cmd> CmdKilled::Do(Stage* stage) {
 
 // CmdMove
 
-CmdMove::CmdMove(const UId& unit, Vec2D dest) : CmdUnit(unit), dest_(dest) {}
+CmdMove::CmdMove(const UId& unit, Vec2D dest) : CmdUnit(Op::kCmdMove, unit), dest_(dest) {}
 
 unique_ptr<Cmd> CmdMove::Do(Stage* game) {
   auto unit = game->LookupUnit(unit_);
@@ -294,7 +318,7 @@ unique_ptr<Cmd> CmdMove::Do(Stage* game) {
 
 CmdAction::CmdAction() : CmdAction(Flag::kDecompose) {}
 
-CmdAction::CmdAction(Flag flag) : cmd_move_(nullptr), cmd_act_(nullptr), flag_(flag) {}
+CmdAction::CmdAction(Flag flag) : Cmd(Op::kCmdAction), cmd_move_(nullptr), cmd_act_(nullptr), flag_(flag) {}
 
 void CmdAction::SetCmdMove(unique_ptr<CmdMove> cmd) { cmd_move_ = std::move(cmd); }
 
@@ -310,7 +334,7 @@ unique_ptr<Cmd> CmdAction::Do(Stage* game) {
     UNREACHABLE("Unsupported");
 #if 0
     if (cmd_move_ != nullptr) {
-      unique_ptr<Cmd> tmp = cmd_move_->Do(game);
+      unique_ptr<Cmd> tmp = cmd_move_->Dispatch(game);
       ASSERT(tmp == nullptr);
     }
 
@@ -325,7 +349,7 @@ unique_ptr<Cmd> CmdAction::Do(Stage* game) {
   } else if (flag_ == Flag::kUserInput) {
     // Do cmd_move_ immediately (Not to play move animation)
     if (cmd_move_ != nullptr) {
-      unique_ptr<Cmd> tmp = cmd_move_->Do(game);
+      unique_ptr<Cmd> tmp = cmd_move_->Dispatch(game);
       ASSERT(tmp == nullptr);
     }
     if (cmd_act_ != nullptr) {
@@ -355,7 +379,7 @@ unique_ptr<Cmd> CmdAction::Do(Stage* game) {
 
 // CmdEndTurn
 
-CmdEndTurn::CmdEndTurn() : Cmd() {}
+CmdEndTurn::CmdEndTurn() : Cmd(Op::kCmdEndTurn) {}
 
 unique_ptr<Cmd> CmdEndTurn::Do(Stage* game) {
   game->EndForceTurn();
@@ -364,18 +388,51 @@ unique_ptr<Cmd> CmdEndTurn::Do(Stage* game) {
 
 // CmdPlayAI
 
-CmdPlayAI::CmdPlayAI() : Cmd() {}
+CmdPlayAI::CmdPlayAI(Mode mode) : Cmd(Op::kCmdPlayAI), mode_(mode) {}
+
+void CmdPlayAI::SetReplay(vector<unique_ptr<Cmd>> pushes, unique_ptr<Cmd> result) {
+  ASSERT(mode_ == Mode::kReplay);
+  replay_pushes_ = std::move(pushes);
+  replay_result_ = std::move(result);
+}
 
 unique_ptr<Cmd> CmdPlayAI::Do(Stage* game) {
+  if (mode_ == Mode::kReplay) {
+    for (auto& cmd : replay_pushes_) {
+      game->Push(std::move(cmd));
+    }
+    return std::move(replay_result_);
+  }
+
+  if (mode_ == Mode::kPhase || mode_ == Mode::kSearch) {
+    // A search a frontend has started on a worker is taken in any case, so it is stopped before the stage changes
+    unique_ptr<AISearchTask> task = (mode_ == Mode::kSearch) ? game->TakeAISearch() : nullptr;
+    // The rest of the phase is planned again only when the stage is not what the plan expects
+    AIPhasePlan* plan = game->ai_phase_plan();
+    if (plan == nullptr || !plan->HasNext(game)) {
+      if (mode_ == Mode::kPhase) {
+        game->SetAIPhasePlan(AIPlanner{game}.Plan());
+      } else if (task != nullptr) {
+        game->SetAIPhasePlan(task->Finish());
+      } else {
+        AISearch search{game};
+        search.Search(game->ai_search_budget());
+        game->SetAIPhasePlan(search.Result());
+      }
+      plan = game->ai_phase_plan();
+    }
+    unique_ptr<Cmd> cmd = plan->Next(game);
+    return (cmd != nullptr) ? std::move(cmd) : std::make_unique<CmdEndTurn>();
+  }
+
   UserInterface* ui = game->user_interface();
   AIExecutor ai_executor{ui};
-
   return ai_executor.Step();
 }
 
 // CmdGameVictory
 
-CmdGameVictory::CmdGameVictory() : Cmd() {}
+CmdGameVictory::CmdGameVictory() : Cmd(Op::kCmdGameVictory) {}
 
 unique_ptr<Cmd> CmdGameVictory::Do(Stage* game) {
   auto lua = game->lua_script();
@@ -389,7 +446,7 @@ unique_ptr<Cmd> CmdGameVictory::Do(Stage* game) {
 
 // CmdGameEnd
 
-CmdGameEnd::CmdGameEnd(bool is_victory) : Cmd(), is_victory_(is_victory) {}
+CmdGameEnd::CmdGameEnd(bool is_victory) : Cmd(Op::kCmdGameEnd), is_victory_(is_victory) {}
 
 unique_ptr<Cmd> CmdGameEnd::Do(Stage*) {
   // TODO Update Own units info
@@ -398,7 +455,7 @@ unique_ptr<Cmd> CmdGameEnd::Do(Stage*) {
 
 // CmdSpeak
 
-CmdSpeak::CmdSpeak(const UId& unit, const string& words) : CmdUnit(unit), words_(words) {}
+CmdSpeak::CmdSpeak(const UId& unit, const string& words) : CmdUnit(Op::kCmdSpeak, unit), words_(words) {}
 
 unique_ptr<Cmd> CmdSpeak::Do(Stage*) {
   // Do nothing, UI will do appropriate stuff.
@@ -407,7 +464,8 @@ unique_ptr<Cmd> CmdSpeak::Do(Stage*) {
 
 // CmdRestoreHp
 
-CmdRestoreHp::CmdRestoreHp(const UId& unit, int ratio, int adder) : CmdUnit(unit), ratio_(ratio), adder_(adder) {}
+CmdRestoreHp::CmdRestoreHp(const UId& unit, int ratio, int adder)
+    : CmdUnit(Op::kCmdRestoreHp, unit), ratio_(ratio), adder_(adder) {}
 
 unique_ptr<Cmd> CmdRestoreHp::Do(Stage* stage) {
   auto unit = stage->LookupUnit(unit_);
@@ -427,7 +485,7 @@ int CmdRestoreHp::CalcAmount(UserInterface* gi) const {
 
 // CmdGainExp
 
-CmdGainExp::CmdGainExp(const UId& unit, uint32_t exp) : CmdUnit(unit), exp_(exp) {}
+CmdGainExp::CmdGainExp(const UId& unit, uint32_t exp) : CmdUnit(Op::kCmdGainExp, unit), exp_(exp) {}
 
 unique_ptr<Cmd> CmdGainExp::Do(Stage* game) {
   auto unit = game->LookupUnit(unit_);
@@ -441,7 +499,7 @@ unique_ptr<Cmd> CmdGainExp::Do(Stage* game) {
 
 // CmdLevelUp
 
-CmdLevelUp::CmdLevelUp(const UId& unit) : CmdUnit(unit) {}
+CmdLevelUp::CmdLevelUp(const UId& unit) : CmdUnit(Op::kCmdLevelUp, unit) {}
 
 unique_ptr<Cmd> CmdLevelUp::Do(Stage* game) {
   auto unit = game->LookupUnit(unit_);
@@ -455,7 +513,7 @@ unique_ptr<Cmd> CmdLevelUp::Do(Stage* game) {
 
 // CmdLevelUp
 
-CmdPromote::CmdPromote(const UId& unit) : CmdUnit(unit) {}
+CmdPromote::CmdPromote(const UId& unit) : CmdUnit(Op::kCmdPromote, unit) {}
 
 unique_ptr<Cmd> CmdPromote::Do(Stage* game) {
   auto unit = game->LookupUnit(unit_);
@@ -14,7 +14,7 @@ class CmdInvalid : public Cmd {};
 
 class CmdUnit : public Cmd {
  public:
-  CmdUnit(const UId& uid);
+  CmdUnit(Op op, const UId& uid);
   virtual unique_ptr<Cmd> Do(Stage*) override = 0;
 
  public:
@@ -26,7 +26,7 @@ class CmdUnit : public Cmd {
 
 class CmdTwoUnits : public Cmd {
  public:
-  CmdTwoUnits(const UId&, const UId&);
+  CmdTwoUnits(Op op, const UId&, const UId&);
   virtual unique_ptr<Cmd> Do(Stage*) override = 0;
 
  public:
@@ -41,7 +41,7 @@ class CmdTwoUnits : public Cmd {
 
 class CmdAct : public CmdTwoUnits {
  public:
-  CmdAct(const UId&, const UId&);
+  CmdAct(Op op, const UId&, const UId&);
   virtual unique_ptr<Cmd> Do(Stage*) override = 0;
 };
 
@@ -49,7 +49,6 @@ class CmdEndAction : public CmdUnit {
  public:
   CmdEndAction(const UId&);
   virtual unique_ptr<Cmd> Do(Stage*) override;
-  virtual Cmd::Op op() const override { return Op::kCmdEndAction; }
 
  public:
   virtual void Accept(CmdVisitor& visitor) const override;
@@ -59,7 +58,6 @@ class CmdStay : public CmdAct {
  public:
   CmdStay(const UId&);
   virtual unique_ptr<Cmd> Do(Stage*) override;
-  virtual Cmd::Op op() const override { return Op::kCmdStay; }
 
  public:
   virtual void Accept(CmdVisitor& visitor) const override;
@@ -73,12 +71,12 @@ class CmdBasicAttack : public CmdAct {
  public:
   CmdBasicAttack(const UId&, const UId&, Type);
   virtual unique_ptr<Cmd> Do(Stage*) override;
-  virtual Cmd::Op op() const override { return Op::kCmdBasicAttack; }
 
  public:
   virtual void Accept(CmdVisitor& visitor) const override;
 
  public:
+  Type type() const { return type_; }
   bool IsCounter() { return type_ & Type::kCounter; }
   bool IsSecond() { return type_ & Type::kSecond; }
   void AddToMultiplier(int m) { multiplier_ += m; }
@@ -102,8 +100,7 @@ class CmdMagic : public CmdAct {
  public:
   CmdMagic(const UId&, const UId&, Magic*);
   virtual unique_ptr<Cmd> Do(Stage*) override;
-  virtual Cmd::Op op() const override { return Op::kCmdMagic; }
-  const Magic* magic() { return magic_; }
+  const Magic* magic() const { return magic_; }
 
  public:
   virtual void Accept(CmdVisitor& visitor) const override;
@@ -120,8 +117,8 @@ class CmdActResult : public CmdTwoUnits {
   enum class Type { kNone, kBasicAttack, kMagic };
 
  public:
-  CmdActResult(const UId&, const UId&, Type, Magic*);
-  CmdActResult(const UId&, const UId&, Type);
+  CmdActResult(Op op, const UId&, const UId&, Type, Magic*);
+  CmdActResult(Op op, const UId&, const UId&, Type);
   virtual unique_ptr<Cmd> Do(Stage*) override = 0;
 
  public:
@@ -148,7 +145,6 @@ class CmdHit : public CmdActResult {
   CmdHit(const UId&, const UId&, Type, HitType, Magic*, int);
   CmdHit(const UId&, const UId&, Type, HitType, int);
   virtual unique_ptr<Cmd> Do(Stage*) override;
-  virtual Cmd::Op op() const override { return Op::kCmdHit; }
 
  public:
   virtual void Accept(CmdVisitor& visitor) const override;
@@ -167,7 +163,6 @@ class CmdMiss : public CmdActResult {
   CmdMiss(const UId&, const UId&, Type, Magic*);
   CmdMiss(const UId&, const UId&, Type);
   virtual unique_ptr<Cmd> Do(Stage*) override;
-  virtual Cmd::Op op() const override { return Op::kCmdMiss; }
 
  public:
   virtual void Accept(CmdVisitor& visitor) const override;
@@ -177,7 +172,6 @@ class CmdKilled : public CmdUnit {
  public:
   CmdKilled(const UId&);
   virtual unique_ptr<Cmd> Do(Stage*) override;
-  virtual Cmd::Op op() const override { return Op::kCmdKilled; }
 
  public:
   virtual void Accept(CmdVisitor& visitor) const override;
@@ -187,7 +181,6 @@ class CmdMove : public CmdUnit {
  public:
   CmdMove(const UId&, Vec2D);
   virtual unique_ptr<Cmd> Do(Stage*) override;
-  virtual Cmd::Op op() const override { return Op::kCmdMove; }
   Vec2D GetDest() const { return dest_; }
 
  public:
@@ -214,7 +207,6 @@ class CmdAction : public Cmd {
   CmdAction();
   CmdAction(Flag);
   virtual unique_ptr<Cmd> Do(Stage*) override;
-  virtual Cmd::Op op() const override { return Op::kCmdAction; }
 
  public:
   virtual void Accept(CmdVisitor& visitor) const override;
@@ -222,6 +214,9 @@ class CmdAction : public Cmd {
  public:
   void SetCmdMove(unique_ptr<CmdMove>);
   void SetCmdAct(unique_ptr<CmdAct>);
+  const CmdMove* cmd_move() const { return cmd_move_.get(); }
+  const CmdAct* cmd_act() const { return cmd_act_.get(); }
+  Flag flag() const { return flag_; }
 
  private:
   unique_ptr<CmdMove> cmd_move_;
@@ -233,7 +228,6 @@ class CmdEndTurn : public Cmd {
  public:
   CmdEndTurn();
   virtual unique_ptr<Cmd> Do(Stage*) override;
-  virtual Cmd::Op op() const override { return Op::kCmdEndTurn; }
 
  public:
   virtual void Accept(CmdVisitor& visitor) const override;
@@ -241,19 +235,32 @@ class CmdEndTurn : public Cmd {
 
 class CmdPlayAI : public Cmd {
  public:
-  CmdPlayAI();
+  enum class Mode {
+    kUnit,    // A unit plays with its own AIMode
+    kPhase,   // Plays the next action of the AIPhasePlan AIPlanner made, planning again if the stage is not as expected
+    kSearch,  // Same as kPhase with AISearch, which plans within the stage's time budget
+    kReplay   // Does what an AI did when a CmdLog was recorded
+  };
+
+ public:
+  CmdPlayAI(Mode mode = Mode::kUnit);
   virtual unique_ptr<Cmd> Do(Stage*) override;
-  virtual Cmd::Op op() const override { return Op::kCmdPlayAI; }
+  Mode mode() const { return mode_; }
+  void SetReplay(vector<unique_ptr<Cmd>> pushes, unique_ptr<Cmd> result);
 
  public:
   virtual void Accept(CmdVisitor& visitor) const override;
+
+ private:
+  Mode mode_;
+  vector<unique_ptr<Cmd>> replay_pushes_;  // For kReplay, pushed while it is done
+  unique_ptr<Cmd> replay_result_;          // For kReplay, returned
 };
 
 class CmdGameVictory : public Cmd {
  public:
   CmdGameVictory();
   virtual unique_ptr<Cmd> Do(Stage*) override;
-  virtual Cmd::Op op() const override { return Op::kCmdGameVictory; }
 
  public:
   virtual void Accept(CmdVisitor& visitor) const override;
@@ -263,7 +270,6 @@ class CmdGameEnd : public Cmd {
  public:
   CmdGameEnd(bool is_victory);
   virtual unique_ptr<Cmd> Do(Stage*) override;
-  virtual Cmd::Op op() const override { return Op::kCmdGameEnd; }
   bool is_victory() const { return is_victory_; }
 
  public:
@@ -277,7 +283,6 @@ class CmdSpeak : public CmdUnit {
  public:
   CmdSpeak(const UId&, const string&);
   virtual unique_ptr<Cmd> Do(Stage*) override;
-  virtual Cmd::Op op() const override { return Op::kCmdSpeak; }
   string GetWords() const { return words_; }
 
  public:
@@ -291,7 +296,6 @@ class CmdRestoreHp : public CmdUnit {
  public:
   CmdRestoreHp(const UId&, int ratio, int adder);
   virtual unique_ptr<Cmd> Do(Stage*) override;
-  virtual Cmd::Op op() const override { return Op::kCmdRestoreHp; }
   int CalcAmount(UserInterface* stage) const;
 
  public:
@@ -306,7 +310,6 @@ class CmdGainExp : public CmdUnit {
  public:
   CmdGainExp(const UId& unit, uint32_t exp);
   virtual unique_ptr<Cmd> Do(Stage*) override;
-  virtual Cmd::Op op() const override { return Op::kCmdGainExp; }
   uint32_t exp() const { return exp_; }
 
  public:
@@ -320,7 +323,6 @@ class CmdLevelUp : public CmdUnit {
  public:
   CmdLevelUp(const UId& unit);
   virtual unique_ptr<Cmd> Do(Stage*) override;
-  virtual Cmd::Op op() const override { return Op::kCmdLevelUp; }
 
  public:
   virtual void Accept(CmdVisitor& visitor) const override;
@@ -330,7 +332,6 @@ class CmdPromote : public CmdUnit {
  public:
   CmdPromote(const UId& unit);
   virtual unique_ptr<Cmd> Do(Stage*) override;
-  virtual Cmd::Op op() const override { return Op::kCmdPromote; }
 
  public:
   virtual void Accept(CmdVisitor& visitor) const override;
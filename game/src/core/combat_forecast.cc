@@ -0,0 +1,240 @@
+#include "combat_forecast.h"
+
+#include "cmds.h"
+#include "event_effect.h"
+#include "formulae.h"
+#include "magic.h"
+#include "stage.h"
+#include "unit.h"
+
+namespace mengde {
+namespace core {
+
+namespace {
+
+// Units of a forecast are indexed 0 for the actor and 1 for the target
+
+// A CmdBasicAttack with the OnCmdEventEffects of both units applied
+struct Strike {
+  int atk;           // Who strikes after all, as a preemptive attack swaps the units
+  double hit;        // Chances as CmdBasicAttack rolls them
+  double critical;
+  double twice;      // A second attack is reserved
+  int damage[2][2];  // By critical and second attack
+  bool counter;      // The defender of the Cmd, before the swap, can counter-attack
+};
+
+// A CmdBasicAttack waiting in the queue
+struct Pending {
+  int atk;  // Attacker of the Cmd, before the swap
+  bool counter;
+  bool second;
+};
+
+const int kMaxPending = 4;
+
+const int kOutcomeSlots = 256;  // Open addressing table of outcomes, more than twice as many as there can be
+
+struct Context {
+  Strike strikes[2][2];  // By the attacker of the Cmd and whether it is a counter-attack
+  int hp[2];             // Before the action
+  CombatForecast::Result* result;
+  int8_t slots[kOutcomeSlots];  // Index of `result->outcomes` or -1
+};
+
+double Chance(int percent) { return std::min(std::max(percent, 0), 100) / 100.0; }
+
+// Same as Unit::IsInRange, with the unit at `pos`
+bool IsInRange(const Unit* unit, Vec2D pos, Vec2D target) {
+  const Vec2D dv = target - pos;
+  bool res = false;
+  unit->attack_range().ForEach([&](Vec2D d) { res |= (dv == d); });
+  return res;
+}
+
+Strike MakeStrike(const Map* map, const Unit* const units[2], const Vec2D pos[2], int atk, bool counter) {
+  BasicAttackModifier modifier{units[atk], units[1 - atk], 0, 0};
+  if (!counter) {
+    units[atk]->RaiseEvent(event::OnCmdEvent::kNormalAttack, &modifier);
+    units[1 - atk]->RaiseEvent(event::OnCmdEvent::kNormalAttacked, &modifier);
+  } else {
+    units[atk]->RaiseEvent(event::OnCmdEvent::kCounterAttack, &modifier);
+    units[1 - atk]->RaiseEvent(event::OnCmdEvent::kCounterAttacked, &modifier);
+  }
+
+  Strike s;
+  s.atk = (modifier.atk == units[0]) ? 0 : 1;
+  const Unit* a = units[s.atk];
+  const Unit* d = units[1 - s.atk];
+  s.hit = Chance(Formulae::ComputeBasicAttackAccuracy(a, d));
+  s.critical = Chance(Formulae::ComputeBasicAttackCritical(a, d));
+  s.twice = Chance(Formulae::ComputeBasicAttackDouble(a, d));
+
+  // Same as CmdBasicAttack::ComputeDamage and the multipliers in CmdBasicAttack::Do
+  int damage = Formulae::ComputeBasicAttackDamage(map, a, pos[s.atk], d, pos[1 - s.atk]);
+  damage = std::max((damage + modifier.addend) * (100 + modifier.multiplier) / 100, 0);
+  for (int critical = 0; critical < 2; critical++) {
+    for (int second = 0; second < 2; second++) {
+      int value = critical ? damage * 3 / 2 : damage;
+      if (second) value = value * 3 / 4;
+      s.damage[critical][second] = std::max(value, 1);
+    }
+  }
+  s.counter = false;
+  return s;
+}
+
+void AddOutcome(CombatForecast::Result* result, int8_t* slots, int dealt, int taken, double chance) {
+  uint32_t slot = static_cast<uint32_t>(dealt * 31 + taken) % kOutcomeSlots;
+  for (; slots[slot] >= 0; slot = (slot + 1) % kOutcomeSlots) {
+    CombatForecast::Outcome& o = result->outcomes[slots[slot]];
+    if (o.dealt == dealt && o.taken == taken) {
+      o.chance += chance;
+      return;
+    }
+  }
+  ASSERT_LT(result->num_outcomes, CombatForecast::kMaxOutcomes);
+  slots[slot] = result->num_outcomes;
+  result->outcomes[result->num_outcomes++] = {dealt, taken, chance};
+}
+
+void Record(CombatForecast::Result* result, int8_t* slots, const int before[2], const int after[2], double chance) {
+  const int dealt = before[1] - std::max(after[1], 0);
+  const int taken = before[0] - std::max(after[0], 0);
+  if (after[1] <= 0) result->kill_rate += chance;
+  if (after[0] <= 0) result->death_rate += chance;
+  result->damage_dealt += dealt * chance;
+  result->damage_taken += taken * chance;
+  AddOutcome(result, slots, dealt, taken, chance);
+}
+
+// The result of an action that does nothing
+CombatForecast::Result Nothing() {
+  CombatForecast::Result result{};
+  result.num_outcomes = 1;
+  result.outcomes[0] = {0, 0, 1.0};
+  return result;
+}
+
+// Follows CmdBasicAttack::Do for the last pending Cmd, down every roll it makes. The hit is applied before the
+// second attack and the counter-attack, and the second attack is done before the counter-attack.
+void Play(Context& ctx, const int hp[2], const Pending* pending, int num_pending, double chance) {
+  if (num_pending == 0) {
+    Record(ctx.result, ctx.slots, ctx.hp, hp, chance);
+    return;
+  }
+
+  const Pending cmd = pending[num_pending - 1];
+  if (hp[0] <= 0 || hp[1] <= 0) {
+    Play(ctx, hp, pending, num_pending - 1, chance);
+    return;
+  }
+
+  const Strike& s = ctx.strikes[cmd.atk][cmd.counter];
+  const int a = s.atk;
+  const int d = 1 - a;
+  if (cmd.counter && !cmd.second) ctx.result->counter_rate += chance;
+
+  // Rolls that lead to the same queue are not told apart
+  Pending queues[2][kMaxPending];
+  int lengths[2];
+  for (int twice = 0; twice < 2; twice++) {
+    Pending* next = queues[twice];
+    std::copy(pending, pending + num_pending - 1, next);
+    lengths[twice] = num_pending - 1;
+    const bool is_last = ((twice == 1) == cmd.second);
+    if (is_last && !cmd.counter && s.counter) next[lengths[twice]++] = {d, true, false};
+    if (!cmd.second && twice == 1) next[lengths[twice]++] = {a, cmd.counter, true};
+    ASSERT_LE(lengths[twice], kMaxPending);
+  }
+  const bool same_queue =
+      lengths[0] == lengths[1] && std::equal(queues[0], queues[0] + lengths[0], queues[1], [](Pending l, Pending r) {
+        return l.atk == r.atk && l.counter == r.counter && l.second == r.second;
+      });
+
+  const double rolls[3] = {1.0 - s.hit, s.hit * (1.0 - s.critical), s.hit * s.critical};  // Miss, normal, critical
+  for (int roll = 0; roll < 3; roll++) {
+    if (rolls[roll] <= 0.0) continue;
+    int next_hp[2] = {hp[0], hp[1]};
+    if (roll > 0) next_hp[d] -= s.damage[roll - 1][cmd.second];
+
+    if (same_queue) {
+      Play(ctx, next_hp, queues[0], lengths[0], chance * rolls[roll]);
+      continue;
+    }
+    if (s.twice < 1.0) Play(ctx, next_hp, queues[0], lengths[0], chance * rolls[roll] * (1.0 - s.twice));
+    if (s.twice > 0.0) Play(ctx, next_hp, queues[1], lengths[1], chance * rolls[roll] * s.twice);
+  }
+}
+
+}  // namespace
+
+CombatForecast::CombatForecast(const Stage* stage) : stage_(stage), map_(stage->GetMap()) {}
+
+CombatForecast::Result CombatForecast::Forecast(const CmdAct& act) const {
+  return Forecast(act, stage_->LookupUnit(act.GetUnitAtk())->position());
+}
+
+CombatForecast::Result CombatForecast::Forecast(const CmdAction& action) const {
+  const CmdAct* act = action.cmd_act();
+  if (act == nullptr) return Nothing();
+  const CmdMove* move = action.cmd_move();
+  return Forecast(*act, move ? move->GetDest() : stage_->LookupUnit(act->GetUnitAtk())->position());
+}
+
+CombatForecast::Result CombatForecast::Forecast(const CmdAct& act, Vec2D atk_pos) const {
+  const Unit* atk = stage_->LookupUnit(act.GetUnitAtk());
+  const Unit* def = stage_->LookupUnit(act.GetUnitDef());
+  switch (act.op()) {
+    case Cmd::Op::kCmdBasicAttack:
+      return ForecastBasicAttack(atk, atk_pos, def);
+    case Cmd::Op::kCmdMagic:
+      return ForecastMagic(atk, def, static_cast<const CmdMagic&>(act).magic());
+    default:
+      return Nothing();
+  }
+}
+
+CombatForecast::Result CombatForecast::ForecastBasicAttack(const Unit* atk, Vec2D atk_pos, const Unit* def) const {
+  const Unit* const units[2] = {atk, def};
+  const Vec2D pos[2] = {atk_pos, def->position()};
+
+  Result result{};
+  Context ctx;
+  for (int i = 0; i < 2; i++) {
+    const Unit* other = units[1 - i];
+    const bool can_counter =
+        IsInRange(other, pos[1 - i], pos[i]) && !other->condition_set().Has(Condition::kStunned);
+    for (int counter = 0; counter < 2; counter++) {
+      ctx.strikes[i][counter] = MakeStrike(map_, units, pos, i, counter == 1);
+      ctx.strikes[i][counter].counter = can_counter;
+    }
+    ctx.hp[i] = units[i]->GetCurrentHpMp().hp;
+  }
+  ctx.result = &result;
+  std::fill(ctx.slots, ctx.slots + kOutcomeSlots, -1);
+
+  const Pending attack{0, false, false};
+  Play(ctx, ctx.hp, &attack, 1, 1.0);
+  return result;
+}
+
+CombatForecast::Result CombatForecast::ForecastMagic(const Unit* atk, const Unit* def, const Magic* magic) const {
+  if (atk->IsDead() || def->IsDead()) return Nothing();
+
+  Result result{};
+  int8_t slots[kOutcomeSlots];
+  std::fill(slots, slots + kOutcomeSlots, -1);
+  const int before[2] = {atk->GetCurrentHpMp().hp, def->GetCurrentHpMp().hp};
+
+  // Same as CombatSim::DoMagic
+  const double hit = Chance(magic->CalcAccuracy(atk, def));
+  int after[2] = {before[0], before[1]};
+  if (magic->HasHP()) after[1] = std::min(before[1] + magic->HPDiff(atk, def), def->GetOriginalHpMp().hp);
+  if (hit < 1.0) Record(&result, slots, before, before, 1.0 - hit);
+  if (hit > 0.0) Record(&result, slots, before, after, hit);
+  return result;
+}
+
+}  // namespace core
+}  // namespace mengde
@@ -0,0 +1,67 @@
+#ifndef MENGDE_CORE_COMBAT_FORECAST_H_
+#define MENGDE_CORE_COMBAT_FORECAST_H_
+
+#include "util/common.h"
+
+namespace mengde {
+namespace core {
+
+class CmdAct;
+class CmdAction;
+class Magic;
+class Map;
+class Stage;
+class Unit;
+
+// CombatForecast works out the odds of an action in closed form, for AI scoring and attack previews
+//
+// A basic attack is followed through every way it can go, a miss, a normal or a critical hit and whether a second
+// attack is reserved, for the attack itself, the second attack and the counter-attack, with the same rules as
+// CmdBasicAttack: 1.5x for a critical hit, 0.75x for a second attack and the OnCmdEventEffects of both units. Each way
+// is weighed by its chance, which is exact where CombatSim::EstimateAction samples. Nothing is rolled, no Cmd is made
+// and the stage is not changed, so it can be called for every candidate of every AI decision.
+//
+// Like CombatSim, what comes after the combat itself is left out, and a magic only forecasts its HP effect.
+
+class CombatForecast {
+ public:
+  // Strikes line up as the attack then the counter-attack(3 strikes with its second attack), the attack, its second
+  // attack and the counter-attack(4 strikes), or the attack and its second attack, each strike a miss, a normal or a
+  // critical hit
+  static const int kMaxOutcomes = 27 + 81 + 9;
+
+  struct Outcome {
+    int dealt;  // HP lost by the target, negative for a heal
+    int taken;  // HP lost by the actor
+    double chance;
+  };
+
+  struct Result {
+    double kill_rate;     // The target is dead
+    double death_rate;    // The actor is dead
+    double damage_dealt;  // Expected `Outcome::dealt`
+    double damage_taken;  // Expected `Outcome::taken`
+    double counter_rate;  // A counter-attack is made
+    int num_outcomes;
+    Outcome outcomes[kMaxOutcomes];  // Every distinct outcome, in no particular order
+  };
+
+ public:
+  CombatForecast(const Stage* stage);
+  Result Forecast(const CmdAct& act) const;
+  Result Forecast(const CmdAction& action) const;
+  Result ForecastBasicAttack(const Unit* atk, Vec2D atk_pos, const Unit* def) const;
+  Result ForecastMagic(const Unit* atk, const Unit* def, const Magic* magic) const;
+
+ private:
+  Result Forecast(const CmdAct& act, Vec2D atk_pos) const;
+
+ private:
+  const Stage* stage_;
+  const Map* map_;
+};
+
+}  // namespace core
+}  // namespace mengde
+
+#endif  // MENGDE_CORE_COMBAT_FORECAST_H_
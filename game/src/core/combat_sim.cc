@@ -0,0 +1,138 @@
+#include "combat_sim.h"
+
+#include "cell.h"
+#include "cmds.h"
+#include "formulae.h"
+#include "magic.h"
+#include "map.h"
+#include "stage.h"
+#include "unit.h"
+
+namespace mengde {
+namespace core {
+
+CombatSim::CombatSim(const Stage* stage) : map_(stage->GetMap()) {
+  stage->ForEachUnitConst([&](const Unit* unit) {
+    ASSERT_EQ(unit->uid().Value(), units_.size());
+    const Attribute& attr = unit->GetCurrentAttr();
+    units_.push_back(unit);
+    hp_.push_back(unit->GetCurrentHpMp().hp);
+    max_hp_.push_back(unit->GetOriginalHpMp().hp);
+    atk_.push_back(attr.atk);
+    def_.push_back(attr.def);
+    dex_.push_back(attr.dex);
+    itl_.push_back(attr.itl);
+    mor_.push_back(attr.mor);
+    level_.push_back(unit->GetLevel());
+    class_indices_.push_back(unit->class_index());
+    positions_.push_back(unit->position());
+    terrain_effects_.push_back(map_->GetCell(unit->position())->GetTerrainEffect(unit->class_index()));
+    stunned_.push_back(unit->condition_set().Has(Condition::kStunned));
+  });
+}
+
+void CombatSim::Move(const UId& uid, Vec2D pos) {
+  const int idx = uid.Value();
+  positions_[idx] = pos;
+  terrain_effects_[idx] = map_->GetCell(pos)->GetTerrainEffect(class_indices_[idx]);
+}
+
+void CombatSim::DoAction(const CmdAction& action, Rng* rng) {
+  if (const CmdMove* move = action.cmd_move()) {
+    Move(move->GetUnit(), move->GetDest());
+  }
+
+  const CmdAct* act = action.cmd_act();
+  if (act == nullptr) return;
+  switch (act->op()) {
+    case Cmd::Op::kCmdBasicAttack:
+      DoBasicAttack(act->GetUnitAtk(), act->GetUnitDef(), rng);
+      break;
+    case Cmd::Op::kCmdMagic:
+      DoMagic(act->GetUnitAtk(), act->GetUnitDef(), static_cast<const CmdMagic*>(act)->magic(), rng);
+      break;
+    default:
+      break;
+  }
+}
+
+void CombatSim::DoBasicAttack(const UId& atk, const UId& def, Rng* rng) {
+  Strike(atk.Value(), def.Value(), false, false, rng);
+}
+
+void CombatSim::DoMagic(const UId& atk, const UId& def, const Magic* magic, Rng* rng) {
+  const int a = atk.Value();
+  const int d = def.Value();
+  int accuracy = Formulae::ComputeAccuracyBase(itl_[a] + mor_[a], itl_[d] + mor_[d], 100);
+  if (rng->Gen(100) >= accuracy) return;
+
+  // Magic damage does not depend on the state simulated here, so the real units are used
+  if (magic->HasHP()) {
+    int diff = magic->HPDiff(units_[a], units_[d]);
+    hp_[d] = std::min(hp_[d] + diff, max_hp_[d]);
+  }
+}
+
+// Follows CmdBasicAttack::Do, the rolls are made in the same order
+// The hit is applied before the second attack and the counter-attack as CmdHit is prepended to them.
+void CombatSim::Strike(int a, int d, bool second, bool counter, Rng* rng) {
+  if (hp_[a] <= 0 || hp_[d] <= 0) return;
+
+  int damage = 0;
+  if (rng->Gen(100) < Formulae::ComputeAccuracyBase(dex_[a], dex_[d], Formulae::kDefaultRatio)) {
+    bool critical = rng->Gen(100) < Formulae::ComputeDoubleCriticalBase(mor_[a], mor_[d]);
+    damage = Formulae::ComputeDamageBase(ApplyTerrainEffect(a, atk_[a]), ApplyTerrainEffect(d, def_[d]), level_[a],
+                                         Formulae::kDefaultRatio);
+    if (critical) damage = damage * 3 / 2;
+    if (second) damage = damage * 3 / 4;
+    damage = std::max(damage, 1);
+  }
+  bool reserve_second = rng->Gen(100) < Formulae::ComputeDoubleCriticalBase(dex_[a], dex_[d]);
+
+  // Like the original, a counter-attack follows a second attack only when the second one rolls a double attack too
+  bool is_last = (reserve_second == second);
+  bool counter_attack = is_last && !counter && IsInRange(d, positions_[a]) && !stunned_[d];
+
+  hp_[d] -= damage;
+  if (!second && reserve_second) Strike(a, d, true, counter, rng);
+  if (counter_attack) Strike(d, a, false, true, rng);
+}
+
+bool CombatSim::IsInRange(int idx, Vec2D pos) const {
+  Vec2D dv = pos - positions_[idx];
+  bool res = false;
+  units_[idx]->attack_range().ForEach([&](Vec2D d) { res |= (dv == d); });
+  return res;
+}
+
+CombatSim::Estimate CombatSim::EstimateAction(const CmdAction& action, int trials, Rng* rng) const {
+  const CmdAct* act = action.cmd_act();
+  ASSERT(act != nullptr);
+  const int a = act->GetUnitAtk().Value();
+  const int d = act->GetUnitDef().Value();
+
+  // Only the two units change during an action, so they are restored rather than copying the whole state each time
+  CombatSim sim = *this;
+  Estimate estimate{0.0, 0.0, 0.0, 0.0};
+  for (int i = 0; i < trials; i++) {
+    sim.hp_[a] = hp_[a];
+    sim.hp_[d] = hp_[d];
+    sim.positions_[a] = positions_[a];
+    sim.terrain_effects_[a] = terrain_effects_[a];
+    sim.DoAction(action, rng);
+    estimate.kill_rate += (sim.hp_[d] <= 0);
+    estimate.death_rate += (sim.hp_[a] <= 0);
+    estimate.damage_dealt += hp_[d] - std::max(sim.hp_[d], 0);
+    estimate.damage_taken += hp_[a] - std::max(sim.hp_[a], 0);
+  }
+  if (trials > 0) {
+    estimate.kill_rate /= trials;
+    estimate.death_rate /= trials;
+    estimate.damage_dealt /= trials;
+    estimate.damage_taken /= trials;
+  }
+  return estimate;
+}
+
+}  // namespace core
+}  // namespace mengde
@@ -0,0 +1,72 @@
+#ifndef MENGDE_CORE_COMBAT_SIM_H_
+#define MENGDE_CORE_COMBAT_SIM_H_
+
+#include "id.h"
+#include "util/common.h"
+#include "util/rng.h"
+
+namespace mengde {
+namespace core {
+
+class CmdAction;
+class Magic;
+class Map;
+class Stage;
+class Unit;
+
+// CombatSim resolves actions on a copy of the combat state, for AI lookahead
+//
+// It takes a snapshot of what combat depends on, HP, attributes, positions and conditions, into flat arrays indexed
+// by UId, and resolves basic attacks and magics with the same rules as CmdBasicAttack and CmdMagic, including
+// double attacks and counter-attacks, without touching the stage. Randomness comes from the given Rng, so a seed
+// reproduces a whole simulation, and the state is a plain value that can be copied to branch off.
+//
+// Left out are what the rules do after the combat itself: experience, level ups, equipment events and the stat and
+// condition effects of magics. HP effects of magics are applied.
+
+class CombatSim {
+ public:
+  struct Estimate {
+    double kill_rate;     // The target is dead
+    double death_rate;    // The actor is dead, by counter-attacks
+    double damage_dealt;  // Average HP lost by the target
+    double damage_taken;  // Average HP lost by the actor
+  };
+
+ public:
+  CombatSim(const Stage* stage);
+  int GetHP(const UId& uid) const { return hp_[uid.Value()]; }
+  bool IsDead(const UId& uid) const { return hp_[uid.Value()] <= 0; }
+  Vec2D GetPosition(const UId& uid) const { return positions_[uid.Value()]; }
+  void Move(const UId& uid, Vec2D pos);
+  void DoAction(const CmdAction& action, Rng* rng);
+  void DoBasicAttack(const UId& atk, const UId& def, Rng* rng);
+  void DoMagic(const UId& atk, const UId& def, const Magic* magic, Rng* rng);
+  Estimate EstimateAction(const CmdAction& action, int trials, Rng* rng) const;
+
+ private:
+  void Strike(int atk, int def, bool second, bool counter, Rng* rng);
+  bool IsInRange(int idx, Vec2D pos) const;
+  int ApplyTerrainEffect(int idx, int value) const { return value * terrain_effects_[idx] / 100; }
+
+ private:
+  const Map* map_;
+  vector<const Unit*> units_;  // For attack ranges and magic effects, which do not change during a simulation
+  vector<int> hp_;
+  vector<int> max_hp_;
+  vector<int> atk_;
+  vector<int> def_;
+  vector<int> dex_;
+  vector<int> itl_;
+  vector<int> mor_;
+  vector<int> level_;
+  vector<int> class_indices_;
+  vector<Vec2D> positions_;
+  vector<int> terrain_effects_;  // Of the cell each unit stands on, in percent
+  vector<bool> stunned_;
+};
+
+}  // namespace core
+}  // namespace mengde
+
+#endif  // MENGDE_CORE_COMBAT_SIM_H_
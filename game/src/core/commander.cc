@@ -1,10 +1,14 @@
 #include "commander.h"
 #include "cmd_queue.h"
+#include "cmd_recorder.h"
+#include "state_history.h"
 
 namespace mengde {
 namespace core {
 
-Commander::Commander() : cmdq_current_(new CmdQueue()), cmdq_history_(new CmdQueue()) {}
+Commander::Commander() : cmdq_current_(new CmdQueue()), history_(new StateHistory()), recorder_(nullptr) {}
+
+Commander::~Commander() {}
 
 bool Commander::HasNext() const { return !cmdq_current_->IsEmpty(); }
 
@@ -15,14 +19,35 @@ const Cmd* Commander::GetNextCmdConst() const {
 
 void Commander::DoNext(Stage* game) {
   ASSERT(HasNext());
-  auto cmd_done = cmdq_current_->Do(game);
-  cmdq_history_->Append(std::move(cmd_done));
+  // The Cmd done is dropped, as what it changed is kept by the history
+  if (recorder_ != nullptr) recorder_->OnDoBegin(*cmdq_current_);
+  history_->Begin(game, *cmdq_current_->GetNextCmdConst());
+  cmdq_current_->Do(game);
+  history_->End(game, !HasNext());
+  if (recorder_ != nullptr) recorder_->OnDoEnd(*cmdq_current_);
 }
 
 void Commander::Push(unique_ptr<Cmd> cmd) {
   ///  ASSERT(cmd != nullptr);
+  if (recorder_ != nullptr && cmd != nullptr) recorder_->OnPush(*cmd);
   cmdq_current_->Append(std::move(cmd));
 }
 
+bool Commander::CanUndo() const { return !HasNext() && history_->CanUndo(); }
+
+bool Commander::CanRedo() const { return !HasNext() && history_->CanRedo(); }
+
+bool Commander::Undo(Stage* game) {
+  if (!CanUndo() || !history_->Undo(game)) return false;
+  if (recorder_ != nullptr) recorder_->OnUndo();
+  return true;
+}
+
+bool Commander::Redo(Stage* game) {
+  if (!CanRedo() || !history_->Redo(game)) return false;
+  if (recorder_ != nullptr) recorder_->OnRedo();
+  return true;
+}
+
 }  // namespace core
 }  // namespace mengde
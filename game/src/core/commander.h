@@ -8,23 +8,31 @@ namespace core {
 
 class Cmd;
 class CmdQueue;
+class CmdRecorder;
 class Stage;
+class StateHistory;
 
 class Commander {
  public:
   Commander();
+  ~Commander();
   bool HasNext() const;
   const Cmd* GetNextCmdConst() const;
   void DoNext(Stage*);
-  //  void UnDo(Stage*);
   void Push(unique_ptr<Cmd>);
+  bool CanUndo() const;
+  bool CanRedo() const;
+  bool Undo(Stage*);
+  bool Redo(Stage*);
+  void SetRecorder(CmdRecorder* recorder) { recorder_ = recorder; }
 
  public:
   const CmdQueue& queue() const { return *cmdq_current_.get(); }
 
  private:
   unique_ptr<CmdQueue> cmdq_current_;
-  unique_ptr<CmdQueue> cmdq_history_;
+  unique_ptr<StateHistory> history_;
+  CmdRecorder* recorder_;  // Not owned, may be nullptr
 };
 
 }  // namespace core
@@ -14,6 +14,8 @@ TurnBased ConditionSet::Get(Condition condition) const {
 
 void ConditionSet::Set(Condition condition, const TurnBased& turn_based) { set_.insert({condition, turn_based}); }
 
+void ConditionSet::Unset(Condition condition) { set_.erase(condition); }
+
 void ConditionSet::NextTurn() {
   for (auto it = set_.begin(); it != set_.end();) {
     auto& turns = it->second;
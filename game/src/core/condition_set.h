@@ -17,6 +17,7 @@ class ConditionSet {
   bool Has(Condition condition) const;
   TurnBased Get(Condition condition) const;
   void Set(Condition condition, const TurnBased& turn_based);
+  void Unset(Condition condition);
   void NextTurn();
   void Iterate(const std::function<void(Condition, TurnBased)>& fn) const;
 
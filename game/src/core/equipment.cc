@@ -42,5 +42,10 @@ void Equipment::RaiseEvent(event::OnCmdEvent type, Unit* unit, CmdAct* act) cons
   effect_list.RaiseEvent(type, unit, act);
 }
 
+void Equipment::RaiseEvent(event::OnCmdEvent type, const Unit* unit, BasicAttackModifier* modifier) const {
+  const auto& effect_list = volatile_attribute_.event_effect_list();
+  effect_list.RaiseEvent(type, unit, modifier);
+}
+
 }  // namespace core
 }  // namespace mengde
@@ -20,6 +20,7 @@ class Equipment : public IEvent {
  public:
   virtual unique_ptr<Cmd> RaiseEvent(event::GeneralEvent, Unit*) const override;
   virtual void RaiseEvent(event::OnCmdEvent, Unit*, CmdAct*) const override;
+  virtual void RaiseEvent(event::OnCmdEvent, const Unit*, BasicAttackModifier*) const override;
 
  public:
   Equipment(const std::string&, Type);
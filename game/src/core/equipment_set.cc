@@ -98,5 +98,14 @@ void EquipmentSet::RaiseEvent(event::OnCmdEvent type, Unit* unit, CmdAct* act) c
   if (aid != nullptr) aid->RaiseEvent(type, unit, act);
 }
 
+void EquipmentSet::RaiseEvent(event::OnCmdEvent type, const Unit* unit, BasicAttackModifier* modifier) const {
+  const Equipment* weapon = GetWeapon();
+  const Equipment* armor = GetArmor();
+  const Equipment* aid = GetAid();
+  if (weapon != nullptr) weapon->RaiseEvent(type, unit, modifier);
+  if (armor != nullptr) armor->RaiseEvent(type, unit, modifier);
+  if (aid != nullptr) aid->RaiseEvent(type, unit, modifier);
+}
+
 }  // namespace core
 }  // namespace mengde
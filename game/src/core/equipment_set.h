@@ -28,6 +28,7 @@ class EquipmentSet : public IEvent {
  public:
   virtual unique_ptr<Cmd> RaiseEvent(event::GeneralEvent, Unit*) const override;
   virtual void RaiseEvent(event::OnCmdEvent, Unit*, CmdAct*) const override;
+  virtual void RaiseEvent(event::OnCmdEvent, const Unit*, BasicAttackModifier*) const override;
 
  private:
   IEquipper* equipper_;
@@ -47,17 +47,28 @@ void OCEEPreemptiveAttack::OnEvent(Unit* unit, CmdAct* act) {
   }
 }
 
+void OCEEPreemptiveAttack::OnEvent(const Unit* unit, BasicAttackModifier* modifier) const {
+  if (modifier->def == unit) {
+    std::swap(modifier->atk, modifier->def);
+  }
+}
+
 // class OCEEEnhanceBasicAttack
 OCEEEnhanceBasicAttack::OCEEEnhanceBasicAttack(event::OnCmdEvent type, int multiplier, int addend, TurnBased turn)
     : OnCmdEventEffect(type, turn), multiplier_(multiplier), addend_(addend) {}
 
 void OCEEEnhanceBasicAttack::OnEvent(Unit* unit, CmdAct* act) {
   LOG_INFO("'%s' the damage will be enhanced by (%d%%,+%d)", unit->id().c_str(), multiplier_, addend_);
-  CmdBasicAttack* ba = dynamic_cast<CmdBasicAttack*>(act);
-  ASSERT(ba != nullptr);
+  ASSERT(act->op() == Cmd::Op::kCmdBasicAttack);
+  CmdBasicAttack* ba = static_cast<CmdBasicAttack*>(act);
   ba->AddToMultiplier(multiplier_);
   ba->AddToAddend(addend_);
 }
 
+void OCEEEnhanceBasicAttack::OnEvent(const Unit*, BasicAttackModifier* modifier) const {
+  modifier->multiplier += multiplier_;
+  modifier->addend += addend_;
+}
+
 }  // namespace core
 }  // namespace mengde
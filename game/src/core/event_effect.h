@@ -39,13 +39,24 @@ class GeneralEventEffect : public EventEffectBase {
   event::GeneralEvent type_;
 };
 
+// BasicAttackModifier is what OnCmdEventEffects would do to a CmdBasicAttack, for forecasting one without a Cmd
+
+struct BasicAttackModifier {
+  const Unit* atk;
+  const Unit* def;
+  int multiplier;
+  int addend;
+};
+
 // OnCmdEventEffect is event effect that can modify CmdAction.
 // Different from GeneralEventEffect, this cannot generate Cmds it can only modify CmdAction passed as an argument.
+// The const `OnEvent` must do to a BasicAttackModifier the same as the other one does to a CmdBasicAttack.
 
 class OnCmdEventEffect : public EventEffectBase {
  public:
   OnCmdEventEffect(event::OnCmdEvent type, TurnBased turn = TurnBased{});
   virtual void OnEvent(Unit* unit, CmdAct* act) = 0;
+  virtual void OnEvent(const Unit* unit, BasicAttackModifier* modifier) const = 0;
   bool type(event::OnCmdEvent type) { return type_ == type; }
 
  private:
@@ -74,12 +85,14 @@ class OCEEPreemptiveAttack : public OnCmdEventEffect {
  public:
   OCEEPreemptiveAttack(event::OnCmdEvent type, TurnBased turn = TurnBased{});
   virtual void OnEvent(Unit* unit, CmdAct* act) override;
+  virtual void OnEvent(const Unit* unit, BasicAttackModifier* modifier) const override;
 };
 
 class OCEEEnhanceBasicAttack : public OnCmdEventEffect {
  public:
   OCEEEnhanceBasicAttack(event::OnCmdEvent type, int multiplier, int addend, TurnBased turn = TurnBased{});
   virtual void OnEvent(Unit* unit, CmdAct* act) override;
+  virtual void OnEvent(const Unit* unit, BasicAttackModifier* modifier) const override;
 
  private:
   int multiplier_;
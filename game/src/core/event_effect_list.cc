@@ -41,6 +41,14 @@ void EventEffectList::RaiseEvent(event::OnCmdEvent type, Unit* unit, CmdAct* act
   }
 }
 
+void EventEffectList::RaiseEvent(event::OnCmdEvent type, const Unit* unit, BasicAttackModifier* modifier) const {
+  for (auto e : oncmd_elements_) {
+    if (e->type(type)) {
+      e->OnEvent(unit, modifier);
+    }
+  }
+}
+
 void EventEffectList::NextTurn() {
   auto pred = [](EventEffectBase* e) {
     bool remove = (e->turn().left() == 0);
@@ -13,6 +13,7 @@ class EventEffectList : public IEvent {
  public:
   virtual unique_ptr<Cmd> RaiseEvent(event::GeneralEvent, Unit *) const override;
   virtual void RaiseEvent(event::OnCmdEvent, Unit *, CmdAct *) const override;
+  virtual void RaiseEvent(event::OnCmdEvent, const Unit *, BasicAttackModifier *) const override;
 
  public:
   EventEffectList();
@@ -1,6 +1,8 @@
 #ifndef MENGDE_CORE_FORCE_H_
 #define MENGDE_CORE_FORCE_H_
 
+#include <stdint.h>
+
 namespace mengde {
 namespace core {
 
@@ -14,6 +16,21 @@ enum class Force {
   kLast = 0x08  // Not a real value
 };
 
+const int kNumForces = 3;
+
+// Index of a single force, from 0 for Force::kFirst
+inline int ForceToIndex(Force force) {
+  int index = 0;
+  for (uint32_t f = (uint32_t)force; f > (uint32_t)Force::kFirst; f >>= 1) index++;
+  return index;
+}
+
+inline bool IsHostile(Force a, Force b) {
+  if (((uint32_t)a & (uint32_t)Force::kFriendly) && ((uint32_t)b & (uint32_t)Force::kEnemy)) return true;
+  if (((uint32_t)b & (uint32_t)Force::kFriendly) && ((uint32_t)a & (uint32_t)Force::kEnemy)) return true;
+  return false;
+}
+
 }  // namespace core
 }  // namespace mengde
 
@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 
+#include "util/common.h"
+
 namespace mengde {
 namespace core {
 
@@ -15,6 +17,7 @@ class Formulae {
 
  public:
   static int ComputeBasicAttackDamage(const Map*, const Unit*, const Unit*, int = kDefaultRatio);
+  static int ComputeBasicAttackDamage(const Map*, const Unit*, Vec2D, const Unit*, Vec2D, int = kDefaultRatio);
   static int ComputeMagicDamage(const Map*, const Unit*, const Unit*, int = kDefaultRatio);
   static int ComputeBasicAttackAccuracy(const Unit*, const Unit*, int = kDefaultRatio);
   static int ComputeMagicAccuracy(const Unit*, const Unit*, int = kDefaultRatio);
@@ -23,10 +26,21 @@ class Formulae {
   static uint32_t ComputeExp(const Unit*, const Unit*);
   static int ApplyRatio(int, int);
 
- private:
+  // Kernels on plain values, for callers that keep stats apart from Unit
   static int ComputeDamageBase(int, int, int, int);
   static int ComputeAccuracyBase(int, int, int);
   static int ComputeDoubleCriticalBase(int, int);
+
+  // Batch kernels over arrays, `out[i]` is the same as the scalar kernel for element i of each array
+  //
+  // Damage takes the terrain effects of both sides, as a percentage like Cell::ApplyTerrainEffect. The loops have no
+  // branches, so the compiler can vectorize them. Stats must not be negative, which the scalar kernels assume too.
+  static void ComputeDamageBatch(int n, const int* atk, const int* atk_effect, const int* def, const int* def_effect,
+                                 const int* atk_lv, int ratio, int* out);
+  static void ComputeAccuracyBatch(int n, const int* atk, const int* def, int cap, int* out);
+  static void ComputeDoubleCriticalBatch(int n, const int* atk, const int* def, int* out);
+
+ private:
   Formulae();  // Prevent instantiation
 };
 
@@ -102,5 +102,11 @@ void Hero::Promote(const UnitClassManager* ucm) {
   UpdateStat();
 }
 
+void Hero::SetClassAndLevel(const HeroClass* unit_class, const Level& level) {
+  unit_class_ = unit_class;
+  level_ = level;
+  UpdateStat();
+}
+
 }  // namespace core
 }  // namespace mengde
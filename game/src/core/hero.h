@@ -44,6 +44,7 @@ class Hero : public IUnitBase, IEquipper {
   void LevelUp();
   bool ReadyPromotion() const;
   void Promote(const UnitClassManager* ucm);
+  void SetClassAndLevel(const HeroClass* unit_class, const Level& level);
   void PutOn(const Equipment*);
   int class_index() const;
 
@@ -13,6 +13,7 @@ namespace core {
 class Cmd;
 class CmdAct;
 class Unit;
+struct BasicAttackModifier;
 
 // IEvent is an interface for raising game events, i.e. for notifying observers
 
@@ -21,6 +22,7 @@ class IEvent {
   virtual ~IEvent() = default;
   virtual unique_ptr<Cmd> RaiseEvent(event::GeneralEvent, Unit*) const = 0;
   virtual void RaiseEvent(event::OnCmdEvent, Unit*, CmdAct*) const = 0;
+  virtual void RaiseEvent(event::OnCmdEvent, const Unit*, BasicAttackModifier*) const = 0;
 };
 
 }  // namespace core
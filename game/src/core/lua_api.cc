@@ -316,4 +316,25 @@ LUA_IMPL(SetAIMode) {
   return 0;
 }
 
+LUA_IMPL(SetAIPlanner) {
+  luab::Lua lua{L};
+  auto enabled = lua.Pop<bool>();
+  auto force = (Force)lua.Pop<int>();
+  auto stage = lua.Pop<Stage*>();
+
+  stage->SetAIPlanner(force, enabled);
+
+  return 0;
+}
+
+LUA_IMPL(SetAISearchBudget) {
+  luab::Lua lua{L};
+  auto budget_ms = lua.Pop<int>();
+  auto stage = lua.Pop<Stage*>();
+
+  stage->SetAISearchBudget(budget_ms);
+
+  return 0;
+}
+
 #undef LUA_IMPL
@@ -30,9 +30,16 @@ void LuaCallbacks::UnregisterEvent(uint32_t id) {
 }
 
 void LuaCallbacks::RunEvents(const luab::LuaClass& stage) {
+  // Handlers may register or unregister events, so iterate over the ids registered before running any of them
+  vector<uint32_t> ids;
   for (const auto& e : events_) {
-    auto id = e.first;
-    auto cb = e.second;
+    ids.push_back(e.first);
+  }
+
+  for (auto id : ids) {
+    auto found = events_.find(id);
+    if (found == events_.end()) continue;  // Unregistered by a handler run earlier
+    auto cb = found->second;
     auto matched = lua_->Call<bool>(cb.condition, stage);
     if (matched) {
       lua_->Call<void>(cb.handler, stage, id);
@@ -4,6 +4,7 @@
 #include "stat_modifier.h"
 #include "stat_modifier_list.h"
 #include "unit.h"
+#include "util/rng.h"
 
 namespace mengde {
 namespace core {
@@ -78,7 +79,9 @@ int Magic::CalcAccuracy(const Unit* unit_atk, const Unit* unit_def) const {
   return Formulae::ComputeMagicAccuracy(unit_atk, unit_def, 100 /* force */);
 }
 
-bool Magic::TryPerform(Unit* unit_atk, Unit* unit_def) { return GenRandom(100) < CalcAccuracy(unit_atk, unit_def); }
+bool Magic::TryPerform(Unit* unit_atk, Unit* unit_def, Rng* rng) {
+  return rng->Gen(100) < CalcAccuracy(unit_atk, unit_def);
+}
 
 void Magic::AddLearnInfo(uint16_t class_id, uint16_t level) { learn_info_list_.push_back({class_id, level}); }
 
@@ -9,6 +9,8 @@
 #include "stat_modifier.h"
 #include "turn_based.h"
 
+class Rng;
+
 namespace mengde {
 namespace core {
 
@@ -107,7 +109,7 @@ class Magic {
 
  public:
   int CalcAccuracy(const Unit*, const Unit*) const;
-  bool TryPerform(Unit*, Unit*);
+  bool TryPerform(Unit*, Unit*, Rng*);
   bool IsAvailible(const Unit*) const;
   bool HasHP() const;
   int HPDiff(const Unit* atk, const Unit* def) const;
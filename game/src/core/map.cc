@@ -5,6 +5,7 @@
 #include "cell.h"
 #include "core/path_tree.h"
 #include "hero_class.h"
+#include "path_finder.h"
 #include "unit.h"
 #include "util/common.h"
 
@@ -17,152 +18,112 @@ Map::Map(const UserInterface* ui, const vector<string>& input, const string& bit
   int cols = input[0].size();
   size_ = {cols, rows};
 
-  grid_.resize(rows);
+  terrain_indices_.resize(rows * cols);
   for (int i = 0; i < rows; i++) {
-    grid_[i].resize(cols);
     for (int j = 0; j < cols; j++) {
       Terrain* terrain = tm->Get(string(1, input[i][j]));
       ASSERT(terrain != NULL);
-      grid_[i][j] = new Cell(terrain);
+      auto found = std::find(terrains_.begin(), terrains_.end(), terrain);
+      if (found == terrains_.end()) {
+        found = terrains_.insert(terrains_.end(), terrain);
+      }
+      terrain_indices_[SerializeVec2D({j, i})] = found - terrains_.begin();
+    }
+  }
+  ASSERT_LE(terrains_.size(), 256);
+
+  const int num_terrains = terrains_.size();
+  const int num_classes = terrains_[0]->GetNumClasses();
+  move_costs_.resize(num_classes * num_terrains);
+  for (int c = 0; c < num_classes; c++) {
+    for (int t = 0; t < num_terrains; t++) {
+      int cost = terrains_[t]->GetMoveCost(c);
+      ASSERT(0 < cost && cost < 256);
+      move_costs_[c * num_terrains + t] = cost;
     }
   }
-}
 
-Map::~Map() {
-  for (int i = 0; i < size_.y; i++) {
-    for (int j = 0; j < size_.x; j++) {
-      delete grid_[i][j];
+  // Costs are fixed for the whole stage, so the path engine can read a cost with a single load
+  move_cost_layers_.resize(num_classes * rows * cols);
+  for (int c = 0; c < num_classes; c++) {
+    const uint8_t* costs = GetMoveCostTable(c);
+    uint8_t* layer = &move_cost_layers_[c * rows * cols];
+    for (int i = 0; i < rows * cols; i++) {
+      layer[i] = costs[terrain_indices_[i]];
     }
   }
+
+  units_.resize(rows * cols);
+  cells_.reserve(rows * cols);
+  for (int i = 0; i < rows * cols; i++) {
+    cells_.emplace_back(terrains_[terrain_indices_[i]], &units_[i]);
+  }
+
+  for (int i = 0; i < kNumForces; i++) {
+    hostile_placed_[i].assign(rows * cols, false);
+    hostile_zoc_[i].assign(rows * cols, false);
+  }
 }
 
+Map::~Map() {}
+
 string Map::GetModelId() { return bitmap_path_; }
 
-const Cell* Map::GetCell(int c, int r) const {
-  ASSERT(IsValidCoords({c, r}));
-  return grid_[r][c];
-}
+const Cell* Map::GetCell(int c, int r) const { return GetCell({c, r}); }
 
 const Cell* Map::GetCell(Vec2D v) const {
   ASSERT(IsValidCoords(v));
-  return grid_[v.y][v.x];
+  return &cells_[SerializeVec2D(v)];
 }
 
-bool Map::UnitInCell(Vec2D c) const { return IsValidCoords(c) && grid_[c.y][c.x]->IsUnitPlaced(); }
+bool Map::UnitInCell(Vec2D c) const { return IsValidCoords(c) && !units_[SerializeVec2D(c)].IsNone(); }
 
 UId Map::GetUnitId(Vec2D c) const {
   ASSERT(UnitInCell(c));
-  return grid_[c.y][c.x]->GetUnit();
+  return units_[SerializeVec2D(c)];
 }
 
 void Map::RemoveUnit(Vec2D c) {
   ASSERT(UnitInCell(c));
-  grid_[c.y][c.x]->Empty();
+  EmptyCell(c);
 }
 
 Terrain* Map::GetTerrain(Vec2D c) {
   ASSERT(IsValidCoords(c));
-  return grid_[c.y][c.x]->GetTerrain();
+  return terrains_[terrain_indices_[SerializeVec2D(c)]];
 }
 
 const Terrain* Map::GetTerrain(Vec2D c) const {
   ASSERT(IsValidCoords(c));
-  return grid_[c.y][c.x]->GetTerrain();
+  return terrains_[terrain_indices_[SerializeVec2D(c)]];
 }
 
-// Using Dijkstra Shortest Path Algorithm
-// ( O(N^2) where N is number of vertices )
-PathTree* Map::FindPath(const UId& uid, Vec2D dest) {
-  static const int kDNum = 4;
-  static const int kDRow[] = {0, 0, -1, 1};
-  static const int kDCol[] = {-1, 1, 0, 0};
-  const int N = size_.x * size_.y;
-  const int kInf = 1 << 30;
+// Bounded search, only the cells within the unit's mobility are touched
+SearchArea Map::GetMovableArea(const Unit* unit) const {
+  return SearchArea::Diamond(size_, unit->position(), unit->move());
+}
 
+PathTree* Map::FindMovablePath(const UId& uid) {
   const Unit* unit = ui_->GetUnit(uid);
-
-  vector<int> dist(N, kInf);
-  vector<bool> used(N, false);
-  vector<PathNode*> from(N, NULL);
-  Vec2D coords = unit->position();
-  int sc = SerializeVec2D(coords);
-  int stat_move = kInf;
-  if (dest == Vec2D(-1, -1)) {
-    stat_move = unit->move();
-  }
-  dist[sc] = 0;
-
-  PathTree* pathtree = NULL;
-
-  while (true) {
-    int current = -1;
-
-    // FIXME Optimization
-    // Closest node selection is currently O(N)
-    // This can be done in O(logn) with priority queue
-    // Or it may be possible to do this with BFS
-    for (int i = 0; i < N; i++) {
-      if (used[i]) continue;
-      if (current == -1 || dist[current] > dist[i]) {
-        current = i;
-      }
-    }
-    if (current == -1) break;
-
-    Vec2D vec_current = DeserializeVec2D(current);
-    used[current] = true;
-
-    if (IsHostilePlaced(uid, vec_current)) continue;
-
-    if (dist[current] <= stat_move) {
-      if (pathtree == nullptr) {
-        pathtree = new PathTree(vec_current);
-        from[current] = pathtree->GetRoot();
-      } else {
-        from[current] = pathtree->Adopt(vec_current, from[current]);
-        if (vec_current == dest) {
-          return pathtree;
-        }
-      }
-    } else {
-      break;
-    }
-
-    for (int i = 0; i < kDNum; i++) {
-      int nr = vec_current.y + kDRow[i];
-      int nc = vec_current.x + kDCol[i];
-      Vec2D nvec(nc, nr);
-      if (!IsValidCoords(nvec)) continue;
-      int next = SerializeVec2D(nvec);
-      int new_dist = dist[current] + grid_[nr][nc]->GetMoveCost(unit->class_index());
-
-      // handle ZOC
-      if (new_dist < stat_move && IsHostileAdjacent(uid, nvec) && nvec != dest) {
-        new_dist = stat_move;
-      }
-
-      if (dist[next] > new_dist) {
-        dist[next] = new_dist;
-        from[next] = from[current];
-      }
-    }
-  }
-
-  return pathtree;
+  return PathFinder{this, unit, GetMovableArea(unit)}.Find(unit->move(), {-1, -1});
 }
 
-PathTree* Map::FindMovablePath(const UId& uid) { return FindPath(uid, {-1, -1}); }
+void Map::FindMovablePos(const UId& uid, vector<Vec2D>* out) {
+  const Unit* unit = ui_->GetUnit(uid);
+  PathFinder{this, unit, GetMovableArea(unit)}.FindReachable(unit->move(), out);
+}
 
+// Goal directed search over the whole map
 vector<Vec2D> Map::FindPathTo(const UId& uid, Vec2D dest) {
-  unique_ptr<PathTree> pathtree(FindPath(uid, dest));
-  vector<Vec2D> path = pathtree->GetPathToRoot(dest);
-  return path;
+  return PathFinder{this, ui_->GetUnit(uid), SearchArea::Whole(size_)}.FindPathTo(dest);
 }
 
 void Map::PlaceUnit(const UId& uid, Vec2D c) {
   ASSERT(IsValidCoords(c));
-  ASSERT(!grid_[c.y][c.x]->IsUnitPlaced());
-  grid_[c.y][c.x]->SetUnit(uid);
+  ASSERT(!UnitInCell(c));
+  units_[SerializeVec2D(c)] = uid;
+  UpdateHostileBits(c, ui_->GetUnit(uid)->force(), true);
+  NotifyUnitChanged(c);
 }
 
 void Map::MoveUnit(Vec2D src, Vec2D dst) {
@@ -171,42 +132,72 @@ void Map::MoveUnit(Vec2D src, Vec2D dst) {
   PlaceUnit(uid, dst);
 }
 
-void Map::EmptyCell(Vec2D c) { grid_[c.y][c.x]->Empty(); }
+void Map::EmptyCell(Vec2D c) {
+  UId& uid = units_[SerializeVec2D(c)];
+  if (uid.IsNone()) return;
+  Force force = ui_->GetUnit(uid)->force();
+  uid.SetNone();
+  UpdateHostileBits(c, force, false);
+  NotifyUnitChanged(c);
+}
 
-bool Map::IsHostileAdjacent(const UId& uid, Vec2D coords) const {
+// Update the bitsets of the forces hostile to the unit of `force` which is placed on or removed from `c`
+void Map::UpdateHostileBits(Vec2D c, Force force, bool placed) {
   static const int kDNum = 5;
   static const int kDRow[] = {0, 0, 0, -1, 1};
   static const int kDCol[] = {0, -1, 1, 0, 0};
 
-  const Unit* unit = ui_->GetUnit(uid);
-  for (int i = 0; i < kDNum; i++) {
-    int nr = coords.y + kDRow[i];
-    int nc = coords.x + kDCol[i];
-    if (!IsValidCoords({nc, nr})) continue;
-    Vec2D ncoords(nc, nr);
-    if (UnitInCell(ncoords)) {
-      if (unit->IsHostile(ui_->GetUnit(ncoords))) return true;
+  for (int i = 0; i < kNumForces; i++) {
+    Force viewer = static_cast<Force>((uint32_t)Force::kFirst << i);
+    if (!IsHostile(viewer, force)) continue;
+
+    vector<bool>& placed_bits = hostile_placed_[i];
+    vector<bool>& zoc_bits = hostile_zoc_[i];
+    placed_bits[SerializeVec2D(c)] = placed;
+    for (int j = 0; j < kDNum; j++) {
+      Vec2D n(c.x + kDCol[j], c.y + kDRow[j]);
+      if (!IsValidCoords(n)) continue;
+      if (placed) {
+        zoc_bits[SerializeVec2D(n)] = true;
+      } else {
+        // Another hostile unit may still be around
+        bool zoc = false;
+        for (int k = 0; k < kDNum && !zoc; k++) {
+          Vec2D nn(n.x + kDCol[k], n.y + kDRow[k]);
+          zoc = IsValidCoords(nn) && placed_bits[SerializeVec2D(nn)];
+        }
+        zoc_bits[SerializeVec2D(n)] = zoc;
+      }
     }
   }
-  return false;
+}
+
+void Map::NotifyUnitChanged(Vec2D c) {
+  if (on_unit_changed_) on_unit_changed_(c);
+}
+
+bool Map::IsHostileAdjacent(const UId& uid, Vec2D coords) const {
+  return GetHostileZOCBits(ui_->GetUnit(uid)->force())[SerializeVec2D(coords)];
 }
 
 bool Map::IsHostilePlaced(const UId& uid, Vec2D coords) const {
-  Cell* cell = grid_[coords.y][coords.x];
-  ASSERT(cell != nullptr);
-  auto unit = ui_->GetUnit(uid);
-  auto unit_in_cell = cell->GetUnit();
-  if (unit_in_cell && unit->IsHostile(ui_->GetUnit(unit_in_cell))) {
-    return true;
-  }
-  return false;
+  return GetHostilePlacedBits(ui_->GetUnit(uid)->force())[SerializeVec2D(coords)];
 }
 
 bool Map::IsValidCoords(Vec2D c) const { return c.x >= 0 && c.x < size_.x && c.y >= 0 && c.y < size_.y; }
 
+int Map::GetMaxMoveCost(int class_idx) const {
+  const uint8_t* costs = GetMoveCostTable(class_idx);
+  return *std::max_element(costs, costs + terrains_.size());
+}
+
+int Map::GetMinMoveCost(int class_idx) const {
+  const uint8_t* costs = GetMoveCostTable(class_idx);
+  return *std::min_element(costs, costs + terrains_.size());
+}
+
 int Map::ApplyTerrainEffect(const Unit* unit, int value) const {
-  Vec2D v = unit->position();
-  return grid_[v.y][v.x]->ApplyTerrainEffect(unit->class_index(), value);
+  return GetCell(unit->position())->ApplyTerrainEffect(unit->class_index(), value);
 }
 
 }  // namespace core
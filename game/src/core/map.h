@@ -1,7 +1,9 @@
 #ifndef MENGDE_CORE_MAP_H_
 #define MENGDE_CORE_MAP_H_
 
+#include "force.h"
 #include "resource_manager.h"
+#include "search_area.h"
 #include "util/common.h"
 
 #include "user_interface.h"
@@ -21,7 +23,7 @@ class Map {
 
  public:
   string GetModelId();
-  Vec2D GetSize() { return size_; }
+  Vec2D GetSize() const { return size_; }
   const Cell* GetCell(int, int) const;
   const Cell* GetCell(Vec2D) const;
   bool UnitInCell(Vec2D) const;
@@ -33,22 +35,46 @@ class Map {
   void MoveUnit(Vec2D, Vec2D);
   void RemoveUnit(Vec2D);
   PathTree* FindMovablePath(const UId&);
+  void FindMovablePos(const UId&, vector<Vec2D>*);
   vector<Vec2D> FindPathTo(const UId&, Vec2D);
-  int SerializeVec2D(Vec2D v) { return v.y * size_.x + v.x; }
-  Vec2D DeserializeVec2D(int v) { return Vec2D(v % size_.x, v / size_.x); }
+  int SerializeVec2D(Vec2D v) const { return v.y * size_.x + v.x; }
+  Vec2D DeserializeVec2D(int v) const { return Vec2D(v % size_.x, v / size_.x); }
   void PlaceUnit(const UId&, Vec2D);
   bool IsHostileAdjacent(const UId&, Vec2D) const;
   bool IsHostilePlaced(const UId&, Vec2D) const;
+  const vector<bool>& GetHostilePlacedBits(Force force) const { return hostile_placed_[ForceToIndex(force)]; }
+  const vector<bool>& GetHostileZOCBits(Force force) const { return hostile_zoc_[ForceToIndex(force)]; }
   bool IsValidCoords(Vec2D) const;
+  int GetMaxMoveCost(int) const;
+  int GetMinMoveCost(int) const;
+  const uint8_t* GetMoveCostLayer(int class_idx) const { return &move_cost_layers_[class_idx * size_.x * size_.y]; }
+  const uint8_t* GetTerrainIndices() const { return terrain_indices_.data(); }
+  void SetOnUnitChanged(const function<void(Vec2D)>& fn) { on_unit_changed_ = fn; }
 
  private:
-  PathTree* FindPath(const UId&, Vec2D);
+  SearchArea GetMovableArea(const Unit*) const;
+  void NotifyUnitChanged(Vec2D);
+  void UpdateHostileBits(Vec2D, Force, bool);
+  const uint8_t* GetMoveCostTable(int class_idx) const { return &move_costs_[class_idx * terrains_.size()]; }
 
  private:
   const UserInterface* ui_;
   Vec2D size_;
-  vector<vector<Cell*> > grid_;
   string bitmap_path_;
+
+  // Cell data in flat arrays indexed by serialized coords
+  vector<Terrain*> terrains_;         // Distinct terrains on this map
+  vector<uint8_t> terrain_indices_;   // Index of `terrains_` for each cell
+  vector<UId> units_;                 // Unit placed on each cell
+  vector<uint8_t> move_costs_;        // Move cost table indexed by class index * `terrains_.size()` + terrain index
+  vector<uint8_t> move_cost_layers_;  // Move cost of each cell for each class, a layer is a contiguous array of cells
+  vector<Cell> cells_;                // Views for `GetCell`
+
+  // Per force bitsets indexed by serialized coords, the ZOC bit is set for a cell occupied by or adjacent to a hostile
+  // unit of the force. They are updated whenever a unit is placed or removed.
+  vector<bool> hostile_placed_[kNumForces];
+  vector<bool> hostile_zoc_[kNumForces];
+  function<void(Vec2D)> on_unit_changed_;  // Called whenever a unit is placed on or removed from a cell
 };
 
 }  // namespace core
@@ -0,0 +1,44 @@
+#include "movement_range_cache.h"
+
+#include "map.h"
+#include "unit.h"
+
+namespace mengde {
+namespace core {
+
+MovementRangeCache::MovementRangeCache(Map* map) : map_(map), entries_(), num_hits_(0), num_misses_(0) {}
+
+const vector<Vec2D>& MovementRangeCache::Get(const Unit* unit) {
+  const uint32_t idx = unit->uid().Value();
+  if (idx >= entries_.size()) {
+    entries_.resize(idx + 1, Entry{false, {0, 0}, 0, 0, {}});
+  }
+
+  Entry& entry = entries_[idx];
+  if (entry.valid && entry.position == unit->position() && entry.move == unit->move() &&
+      entry.class_index == unit->class_index()) {
+    num_hits_++;
+    return entry.cells;
+  }
+
+  num_misses_++;
+  map_->FindMovablePos(unit->uid(), &entry.cells);
+  entry.valid = true;
+  entry.position = unit->position();
+  entry.move = unit->move();
+  entry.class_index = unit->class_index();
+  return entry.cells;
+}
+
+void MovementRangeCache::OnUnitChanged(Vec2D c) {
+  for (auto& entry : entries_) {
+    if (!entry.valid) continue;
+    Vec2D d = c - entry.position;
+    if (std::abs(d.x) + std::abs(d.y) <= entry.move + 1) {
+      entry.valid = false;
+    }
+  }
+}
+
+}  // namespace core
+}  // namespace mengde
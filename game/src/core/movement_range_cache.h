@@ -0,0 +1,48 @@
+#ifndef MENGDE_CORE_MOVEMENT_RANGE_CACHE_H_
+#define MENGDE_CORE_MOVEMENT_RANGE_CACHE_H_
+
+#include "id.h"
+#include "util/common.h"
+
+namespace mengde {
+namespace core {
+
+class Map;
+class Unit;
+
+// MovementRangeCache keeps the cells reachable by each unit
+//
+// An entry stays valid as long as nothing its search depended on has changed:
+// - The unit's own state is compared on lookup (position, move points and class)
+// - A unit placed on or removed from a cell drops the entries whose search could have seen that cell, which are the
+//   units within `move + 1` cells of it(`+ 1` for ZOC)
+// Terrain never changes during a stage. Conditions that keep a unit still are checked by the caller.
+
+class MovementRangeCache {
+ public:
+  MovementRangeCache(Map* map);
+  const vector<Vec2D>& Get(const Unit*);
+  void OnUnitChanged(Vec2D);
+  uint32_t num_hits() const { return num_hits_; }
+  uint32_t num_misses() const { return num_misses_; }
+
+ private:
+  struct Entry {
+    bool valid;
+    Vec2D position;
+    int move;
+    int class_index;
+    vector<Vec2D> cells;
+  };
+
+ private:
+  Map* map_;
+  vector<Entry> entries_;  // Indexed by UId
+  uint32_t num_hits_;
+  uint32_t num_misses_;
+};
+
+}  // namespace core
+}  // namespace mengde
+
+#endif  // MENGDE_CORE_MOVEMENT_RANGE_CACHE_H_
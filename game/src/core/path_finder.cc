@@ -0,0 +1,183 @@
+#include "path_finder.h"
+
+#include "map.h"
+#include "path_finder_context.h"
+#include "path_tree.h"
+#include "unit.h"
+
+namespace mengde {
+namespace core {
+
+const int PathFinder::kInf;
+
+PathFinder::PathFinder(const Map* map, const Unit* unit, const SearchArea& area)
+    : map_(map), unit_(unit), area_(area), ctx_(PathFinderContext::GetInstance()), num_queued_(0) {}
+
+PathTree* PathFinder::Find(int max_cost, Vec2D dest) {
+  Search(max_cost, dest);
+  return BuildPathTree();
+}
+
+void PathFinder::FindReachable(int max_cost, vector<Vec2D>* out) {
+  Search(max_cost, {-1, -1});
+  out->clear();
+  for (int cell : ctx_->order()) {
+    out->push_back(area_.ToCoords(cell));
+  }
+}
+
+void PathFinder::Search(int max_cost, Vec2D dest) {
+  static const int kDNum = 4;
+  static const int kDRow[] = {0, 0, -1, 1};
+  static const int kDCol[] = {-1, 1, 0, 0};
+
+  const int class_idx = unit_->class_index();
+  const uint8_t* move_costs = map_->GetMoveCostLayer(class_idx);
+  const vector<bool>& hostile_placed = map_->GetHostilePlacedBits(unit_->force());
+  const vector<bool>& hostile_zoc = map_->GetHostileZOCBits(unit_->force());
+
+  // Every distance in the queue lies in [current, current + span) so the buckets can be reused circularly.
+  // With a move budget it is simply the budget, otherwise it is bounded by the most expensive single step.
+  const bool bounded = (max_cost != kInf);
+  const int span = (bounded ? max_cost : map_->GetMaxMoveCost(class_idx)) + 1;
+  ctx_->Reset(area_.size(), span);
+  num_queued_ = 0;
+
+  Push(area_.ToIndex(unit_->position()), 0, -1, 0);
+
+  for (int d = 0; num_queued_ > 0 && d <= max_cost; d++) {
+    vector<int>& bucket = ctx_->GetBucket(d);
+    while (!bucket.empty()) {
+      // Each bucket is a min-heap of cell indices to keep the settlement order deterministic
+      std::pop_heap(bucket.begin(), bucket.end(), std::greater<int>());
+      const int current = bucket.back();
+      bucket.pop_back();
+      num_queued_--;
+
+      if (ctx_->IsSettled(current) || ctx_->GetDist(current) != d) continue;  // Outdated entry
+      ctx_->Settle(current);
+
+      Vec2D vec_current = area_.ToCoords(current);
+      if (hostile_placed[map_->SerializeVec2D(vec_current)]) continue;
+
+      ctx_->order().push_back(current);
+      if (vec_current == dest && ctx_->GetParent(current) != -1) {
+        return;
+      }
+
+      for (int i = 0; i < kDNum; i++) {
+        Vec2D nvec(vec_current.x + kDCol[i], vec_current.y + kDRow[i]);
+        if (!area_.Contains(nvec)) continue;
+        int next = area_.ToIndex(nvec);
+        if (ctx_->IsSettled(next)) continue;
+
+        const int ncell = map_->SerializeVec2D(nvec);
+        int new_dist = d + move_costs[ncell];
+
+        // handle ZOC
+        if (new_dist < max_cost && hostile_zoc[ncell] && nvec != dest) {
+          new_dist = max_cost;
+        }
+
+        // Without a move budget ZOC cells are impassable
+        if (new_dist > max_cost || new_dist >= kInf) continue;
+
+        if (!ctx_->IsSeen(next) || ctx_->GetDist(next) > new_dist) {
+          Push(next, new_dist, current, new_dist);
+        }
+      }
+    }
+  }
+}
+
+vector<Vec2D> PathFinder::FindPathTo(Vec2D dest) {
+  static const int kDNum = 4;
+  static const int kDRow[] = {0, 0, -1, 1};
+  static const int kDCol[] = {-1, 1, 0, 0};
+
+  const Vec2D root = unit_->position();
+  if (dest == root) return {root};
+  if (!area_.Contains(dest)) return {};
+
+  const int class_idx = unit_->class_index();
+  const uint8_t* move_costs = map_->GetMoveCostLayer(class_idx);
+  const vector<bool>& hostile_placed = map_->GetHostilePlacedBits(unit_->force());
+  const vector<bool>& hostile_zoc = map_->GetHostileZOCBits(unit_->force());
+  const int min_cost = map_->GetMinMoveCost(class_idx);
+  auto heuristic = [&](Vec2D c) { return min_cost * (std::abs(c.x - dest.x) + std::abs(c.y - dest.y)); };
+
+  // A step raises the estimated total cost by at most the step cost plus `min_cost`
+  const int span = map_->GetMaxMoveCost(class_idx) + min_cost + 1;
+  ctx_->Reset(area_.size(), span);
+  num_queued_ = 0;
+
+  Push(area_.ToIndex(root), 0, -1, heuristic(root));
+
+  for (int f = heuristic(root); num_queued_ > 0; f++) {
+    vector<int>& bucket = ctx_->GetBucket(f);
+    while (!bucket.empty()) {
+      std::pop_heap(bucket.begin(), bucket.end(), std::greater<int>());
+      const int current = bucket.back();
+      bucket.pop_back();
+      num_queued_--;
+
+      Vec2D vec_current = area_.ToCoords(current);
+      const int d = ctx_->GetDist(current);
+      if (ctx_->IsSettled(current) || d + heuristic(vec_current) != f) continue;  // Outdated entry
+      ctx_->Settle(current);
+
+      if (hostile_placed[map_->SerializeVec2D(vec_current)]) continue;
+
+      if (vec_current == dest) {
+        vector<Vec2D> path;
+        for (int cell = current; cell != -1; cell = ctx_->GetParent(cell)) {
+          path.push_back(area_.ToCoords(cell));
+        }
+        return path;
+      }
+
+      for (int i = 0; i < kDNum; i++) {
+        Vec2D nvec(vec_current.x + kDCol[i], vec_current.y + kDRow[i]);
+        if (!area_.Contains(nvec)) continue;
+        int next = area_.ToIndex(nvec);
+        if (ctx_->IsSettled(next)) continue;
+
+        // Without a move budget ZOC cells are impassable
+        const int ncell = map_->SerializeVec2D(nvec);
+        if (hostile_zoc[ncell] && nvec != dest) continue;
+
+        int new_dist = d + move_costs[ncell];
+        if (!ctx_->IsSeen(next) || ctx_->GetDist(next) > new_dist) {
+          Push(next, new_dist, current, new_dist + heuristic(nvec));
+        }
+      }
+    }
+  }
+
+  return {};
+}
+
+void PathFinder::Push(int cell, int dist, int parent, int priority) {
+  ctx_->SetDist(cell, dist, parent);
+  vector<int>& bucket = ctx_->GetBucket(priority);
+  bucket.push_back(cell);
+  std::push_heap(bucket.begin(), bucket.end(), std::greater<int>());
+  num_queued_++;
+}
+
+PathTree* PathFinder::BuildPathTree() const {
+  const vector<int>& order = ctx_->order();
+  ASSERT(!order.empty());
+
+  PathTree* pathtree = new PathTree(area_, area_.ToCoords(order[0]));
+  for (uint32_t i = 1; i < order.size(); i++) {
+    int cell = order[i];
+    PathNode* parent = pathtree->FindNode(area_.ToCoords(ctx_->GetParent(cell)));
+    ASSERT(parent != nullptr);
+    pathtree->Adopt(area_.ToCoords(cell), parent);
+  }
+  return pathtree;
+}
+
+}  // namespace core
+}  // namespace mengde
@@ -0,0 +1,65 @@
+#ifndef MENGDE_CORE_PATH_FINDER_H_
+#define MENGDE_CORE_PATH_FINDER_H_
+
+#include "search_area.h"
+#include "util/common.h"
+
+namespace mengde {
+namespace core {
+
+class Map;
+class PathFinderContext;
+class PathTree;
+class Unit;
+
+// PathFinder is the shortest path engine for unit movement
+//
+// Move costs are small positive integers, so rather than scanning the whole map for the closest cell the open set is
+// kept in a bucket queue indexed by distance (Dial's algorithm). Buckets form a circular array which only has to
+// span the largest single step, and the search stops as soon as the move budget is exceeded.
+//
+// All the scratch buffers are indexed by the local index of a SearchArea. A movement search only needs the diamond
+// of radius `move` around the unit, so its cost scales with the unit's mobility rather than the map size.
+// The buffers are borrowed from the PathFinderContext of the calling thread, so `FindReachable` does not allocate
+// once the context is warmed up.
+//
+// Cells with the same distance are settled in ascending cell index order, which is the order the former O(N^2)
+// implementation used, therefore the resulting PathTree is identical node by node.
+//
+// A point-to-point query without a move budget(`FindPathTo`) runs A* instead, with the Manhattan distance times the
+// cheapest step cost as the heuristic. The heuristic never overestimates and never drops by more than a step costs,
+// so buckets keyed by the estimated total cost still pop in order and the first path found to the destination is a
+// shortest one. Among shortest paths it may pick a different one than the plain search would.
+//
+// Movement rules are the same as before:
+// - Cells occupied by a hostile unit can neither be passed through nor stopped at
+// - Entering a cell adjacent to a hostile unit(Zone of Control) consumes all the remaining move points,
+//   unless the cell is the destination
+
+class PathFinder {
+ public:
+  static const int kInf = 1 << 30;
+
+ public:
+  PathFinder(const Map* map, const Unit* unit, const SearchArea& area);
+  PathTree* Find(int max_cost, Vec2D dest);
+  void FindReachable(int max_cost, vector<Vec2D>* out);
+  vector<Vec2D> FindPathTo(Vec2D dest);
+
+ private:
+  void Search(int max_cost, Vec2D dest);
+  void Push(int cell, int dist, int parent, int priority);
+  PathTree* BuildPathTree() const;
+
+ private:
+  const Map* map_;
+  const Unit* unit_;
+  SearchArea area_;
+  PathFinderContext* ctx_;
+  int num_queued_;
+};
+
+}  // namespace core
+}  // namespace mengde
+
+#endif  // MENGDE_CORE_PATH_FINDER_H_
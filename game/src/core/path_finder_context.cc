@@ -0,0 +1,59 @@
+#include "path_finder_context.h"
+
+namespace mengde {
+namespace core {
+
+PathFinderContext* PathFinderContext::GetInstance() {
+  static thread_local PathFinderContext instance;
+  return &instance;
+}
+
+PathFinderContext::PathFinderContext() : generation_(0), num_buckets_(0) {}
+
+void PathFinderContext::Reset(int num_cells, int num_buckets) {
+  ASSERT_GT(num_buckets, 0);
+
+  if (seen_.size() < static_cast<size_t>(num_cells)) {
+    seen_.resize(num_cells, 0);
+    settled_.resize(num_cells, 0);
+    dist_.resize(num_cells);
+    parent_.resize(num_cells);
+  }
+
+  generation_++;
+  if (generation_ == 0) {
+    // Wrapped around, stamps from 2^32 searches ago would look fresh
+    std::fill(seen_.begin(), seen_.end(), 0);
+    std::fill(settled_.begin(), settled_.end(), 0);
+    generation_ = 1;
+  }
+
+  // A search may stop early with entries left in the queue
+  if (buckets_.size() < static_cast<size_t>(num_buckets)) {
+    buckets_.resize(num_buckets);
+  }
+  for (int i = 0; i < num_buckets_; i++) {
+    buckets_[i].clear();
+  }
+  num_buckets_ = num_buckets;
+  order_.clear();
+}
+
+int PathFinderContext::GetDist(int cell) const {
+  ASSERT(IsSeen(cell));
+  return dist_[cell];
+}
+
+int PathFinderContext::GetParent(int cell) const {
+  ASSERT(IsSeen(cell));
+  return parent_[cell];
+}
+
+void PathFinderContext::SetDist(int cell, int dist, int parent) {
+  seen_[cell] = generation_;
+  dist_[cell] = dist;
+  parent_[cell] = parent;
+}
+
+}  // namespace core
+}  // namespace mengde
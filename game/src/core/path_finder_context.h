@@ -0,0 +1,50 @@
+#ifndef MENGDE_CORE_PATH_FINDER_CONTEXT_H_
+#define MENGDE_CORE_PATH_FINDER_CONTEXT_H_
+
+#include "util/common.h"
+
+namespace mengde {
+namespace core {
+
+// PathFinderContext is the scratch memory of PathFinder
+//
+// Buffers are kept across searches and only grow, so once they are large enough for the biggest search area a
+// search does not allocate anything. Instead of clearing them, every cell is stamped with the generation of the
+// search that wrote it last and anything with an older stamp is regarded as untouched.
+//
+// There is one context per thread. A context serves one search at a time, so the results must be consumed before the
+// next search on the same thread.
+
+class PathFinderContext {
+ public:
+  static PathFinderContext* GetInstance();
+
+ public:
+  void Reset(int num_cells, int num_buckets);
+  bool IsSeen(int cell) const { return seen_[cell] == generation_; }
+  bool IsSettled(int cell) const { return settled_[cell] == generation_; }
+  int GetDist(int cell) const;
+  int GetParent(int cell) const;
+  void SetDist(int cell, int dist, int parent);
+  void Settle(int cell) { settled_[cell] = generation_; }
+  vector<int>& GetBucket(int dist) { return buckets_[dist % num_buckets_]; }
+  vector<int>& order() { return order_; }
+
+ private:
+  PathFinderContext();
+
+ private:
+  uint32_t generation_;
+  vector<uint32_t> seen_;
+  vector<uint32_t> settled_;
+  vector<int> dist_;
+  vector<int> parent_;
+  vector<int> order_;  // Settled cells in the order of settlement
+  vector<vector<int>> buckets_;
+  int num_buckets_;
+};
+
+}  // namespace core
+}  // namespace mengde
+
+#endif  // MENGDE_CORE_PATH_FINDER_CONTEXT_H_
@@ -9,27 +9,25 @@ PathNode::PathNode(Vec2D data, PathNode* parent) : data_(data), parent_(parent)
 
 // PathTree
 
-PathTree::PathTree(Vec2D root_data) {
-  root_ = new PathNode(root_data);
-  node_list_.push_back(root_);
-}
-
-PathTree::~PathTree() {
-  for (auto itr : node_list_) {
-    delete itr;
-  }
+PathTree::PathTree(const SearchArea& area, Vec2D root_data)
+    : area_(area), slots_(area.size()), num_nodes_(0), root_(NULL) {
+  root_ = Adopt(root_data, NULL);
 }
 
 PathNode* PathTree::Adopt(Vec2D child_data, PathNode* parent_node) {
-  PathNode* new_node = new PathNode(child_data, parent_node);
-  node_list_.push_back(new_node);
+  ASSERT(FindNode(child_data) == NULL);
+  int cell = area_.ToIndex(child_data);
+  PathNode* new_node = &slots_[cell].node;
+  *new_node = PathNode(child_data, parent_node);
+  slots_[num_nodes_++].cell = cell;
   return new_node;
 }
 
 std::vector<Vec2D> PathTree::GetNodeList() {
   std::vector<Vec2D> nodes;
-  for (auto itr : node_list_) {
-    nodes.push_back(itr->GetData());
+  nodes.reserve(num_nodes_);
+  for (int i = 0; i < num_nodes_; i++) {
+    nodes.push_back(slots_[slots_[i].cell].node.GetData());
   }
   return nodes;
 }
@@ -47,10 +45,11 @@ std::vector<Vec2D> PathTree::GetPathToRoot(PathNode* node) {
 std::vector<Vec2D> PathTree::GetPathToRoot(Vec2D vec) { return GetPathToRoot(FindNode(vec)); }
 
 PathNode* PathTree::FindNode(Vec2D vec) {
-  for (auto itr : node_list_) {
-    if (itr->GetData() == vec) return itr;
-  }
-  return NULL;
+  if (!area_.Contains(vec)) return NULL;
+  PathNode* node = &slots_[area_.ToIndex(vec)].node;
+  // Slots of cells not in the tree keep the default data (-1, -1)
+  if (node->GetData() != vec) return NULL;
+  return node;
 }
 
 }  // namespace core
@@ -3,6 +3,7 @@
 
 #include <vector>
 
+#include "search_area.h"
 #include "util/common.h"
 
 namespace mengde {
@@ -10,7 +11,7 @@ namespace core {
 
 class PathNode {
  public:
-  PathNode(Vec2D, PathNode* = NULL);
+  PathNode(Vec2D = {-1, -1}, PathNode* = NULL);
   PathNode* GetParent() { return parent_; }
   Vec2D GetData() { return data_; }
   bool IsRoot() { return parent_ == NULL; }
@@ -23,15 +24,15 @@ class PathNode {
 // PathTree is a tree data structure for saving unit's path
 //
 // Each PathTree node has a pointer to its parent but no children list.
-// PathTree class has a node list that contains the entire nodes
-// which is used for iterating all nodes and freeing when destruction.
+// Nodes live in a single array that has a slot for every cell of the SearchArea, keyed by the cell's local index,
+// so looking up the node of a cell takes constant time. Each slot also holds an entry of the dense list of the cells
+// in the tree in the order of adoption, which is used for iterating all nodes.
 // This is a useful data structure for saving path
 // from Dijkstra's shortest path algorithm.
 
 class PathTree {
  public:
-  PathTree(Vec2D);
-  ~PathTree();
+  PathTree(const SearchArea&, Vec2D);
   PathNode* Adopt(Vec2D, PathNode*);
   std::vector<Vec2D> GetNodeList();
   PathNode* GetRoot() { return root_; }
@@ -41,8 +42,16 @@ class PathTree {
   bool IsNodeExist(Vec2D v) { return FindNode(v) != NULL; }
 
  private:
+  struct Slot {
+    PathNode node;  // Node of the cell with this local index, if adopted
+    int cell;       // Local index of the adopted cell with this order
+  };
+
+ private:
+  SearchArea area_;
+  std::vector<Slot> slots_;
+  int num_nodes_;
   PathNode* root_;
-  std::vector<PathNode*> node_list_;
 };
 
 }  // namespace core
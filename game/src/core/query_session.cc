@@ -0,0 +1,49 @@
+#include "query_session.h"
+
+#include "stage.h"
+
+namespace mengde {
+namespace core {
+
+QuerySession::QuerySession(Stage* stage) : stage_(stage), revision_(0) {}
+
+void QuerySession::Validate() {
+  if (revision_ == stage_->revision()) return;
+  revision_ = stage_->revision();
+  units_.reset();
+  moves_.clear();
+  acts_.clear();
+}
+
+const AvailableUnits& QuerySession::GetUnits() {
+  Validate();
+  if (units_ == nullptr) {
+    units_ = std::make_unique<AvailableUnits>(stage_);
+  }
+  return *units_;
+}
+
+const AvailableMoves& QuerySession::GetMoves(const UnitKey& unit_key) {
+  Validate();
+  auto found = moves_.find(unit_key.Value());
+  if (found == moves_.end()) {
+    UId uid = GetUnits().Get(unit_key);
+    found = moves_.emplace(unit_key.Value(), AvailableMoves(stage_, uid)).first;
+  }
+  return found->second;
+}
+
+const AvailableActs& QuerySession::GetActs(const UnitKey& unit_key, const MoveKey& move_key, ActionType type) {
+  Validate();
+  auto key = std::make_tuple(unit_key.Value(), move_key.Value(), type);
+  auto found = acts_.find(key);
+  if (found == acts_.end()) {
+    UId uid = GetUnits().Get(unit_key);
+    Vec2D move_pos = GetMoves(unit_key).Get(move_key);
+    found = acts_.emplace(key, AvailableActs(stage_, uid, move_pos, type)).first;
+  }
+  return found->second;
+}
+
+}  // namespace core
+}  // namespace mengde
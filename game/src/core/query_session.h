@@ -0,0 +1,43 @@
+#ifndef MENGDE_CORE_QUERY_SESSION_H_
+#define MENGDE_CORE_QUERY_SESSION_H_
+
+#include <map>
+#include <tuple>
+#include <unordered_map>
+
+#include "user_interface.h"
+
+namespace mengde {
+namespace core {
+
+// QuerySession memoizes the query results of UserInterface
+//
+// AI and GUI ask for the same units, moves and acts over and over while nothing changes, which used to redo the
+// movement search and the target scan every time. Results are kept as long as the stage revision is the same as when
+// they were made. Any Cmd executed bumps the revision, so the next query drops everything and starts over.
+//
+// It is not thread-safe, even though the queries of UserInterface that use it are const. Only the thread that plays
+// the stage may query through it, so jobs of ThreadPool and AISearchTask get what they need beforehand.
+
+class QuerySession {
+ public:
+  QuerySession(Stage* stage);
+  const AvailableUnits& GetUnits();
+  const AvailableMoves& GetMoves(const UnitKey& unit_key);
+  const AvailableActs& GetActs(const UnitKey& unit_key, const MoveKey& move_key, ActionType type);
+
+ private:
+  void Validate();
+
+ private:
+  Stage* stage_;
+  uint32_t revision_;
+  unique_ptr<AvailableUnits> units_;
+  std::unordered_map<uint32_t, AvailableMoves> moves_;  // Keyed by UnitKey
+  std::map<std::tuple<uint32_t, uint32_t, ActionType>, AvailableActs> acts_;
+};
+
+}  // namespace core
+}  // namespace mengde
+
+#endif  // MENGDE_CORE_QUERY_SESSION_H_
@@ -45,6 +45,8 @@ class ResourceManager {
     }
   }
 
+  bool Has(const string& id) const { return container_.find(id) != container_.end(); }
+
   uint32_t GetNumElements() { return container_.size(); }
 
   void ForEach(function<void(T*)> f) {
@@ -22,6 +22,7 @@ class Scenario {
 
  public:
   const string& id() const { return scenario_id_; }
+  uint32_t stage_no() const { return stage_no_; }
   bool NextStage();
 
  private:
@@ -0,0 +1,71 @@
+#include "search_area.h"
+
+#include <cmath>
+
+namespace mengde {
+namespace core {
+
+static int ISqrt(int v) {
+  int r = static_cast<int>(std::sqrt(static_cast<double>(v)));
+  while (r * r > v) r--;
+  while ((r + 1) * (r + 1) <= v) r++;
+  return r;
+}
+
+SearchArea SearchArea::Whole(Vec2D map_size) { return SearchArea(map_size, {0, 0}, -1); }
+
+SearchArea SearchArea::Diamond(Vec2D map_size, Vec2D pivot, int radius) {
+  ASSERT_GE(radius, 0);
+  return SearchArea(map_size, pivot, radius);
+}
+
+SearchArea::SearchArea(Vec2D map_size, Vec2D pivot, int radius)
+    : map_size_(map_size), pivot_(pivot), radius_(radius), size_(0) {
+  if (IsWhole()) {
+    size_ = map_size_.x * map_size_.y;
+  } else {
+    size_ = 2 * radius_ * radius_ + 2 * radius_ + 1;
+  }
+}
+
+bool SearchArea::Contains(Vec2D c) const {
+  if (c.x < 0 || c.x >= map_size_.x || c.y < 0 || c.y >= map_size_.y) return false;
+  if (IsWhole()) return true;
+  return std::abs(c.x - pivot_.x) + std::abs(c.y - pivot_.y) <= radius_;
+}
+
+// Number of cells in the diamond rows above `row`
+// Upper rows(including the middle) are 1, 3, 5, ... cells wide and the lower rows mirror them.
+int SearchArea::RowOffset(int row) const {
+  if (row <= radius_) return row * row;
+  int rest = 2 * radius_ + 1 - row;
+  return size_ - rest * rest;
+}
+
+int SearchArea::ToIndex(Vec2D c) const {
+  ASSERT(Contains(c));
+  if (IsWhole()) return c.y * map_size_.x + c.x;
+
+  Vec2D d = c - pivot_;
+  int row = d.y + radius_;
+  return RowOffset(row) + d.x + radius_ - std::abs(d.y);
+}
+
+Vec2D SearchArea::ToCoords(int index) const {
+  ASSERT(0 <= index && index < size_);
+  if (IsWhole()) return Vec2D(index % map_size_.x, index / map_size_.x);
+
+  int row = 0;
+  if (index < (radius_ + 1) * (radius_ + 1)) {
+    row = ISqrt(index);
+  } else {
+    int rest = ISqrt(size_ - index - 1) + 1;  // Ceiling of the square root
+    row = 2 * radius_ + 1 - rest;
+  }
+  int dy = row - radius_;
+  int dx = index - RowOffset(row) - (radius_ - std::abs(dy));
+  return pivot_ + Vec2D(dx, dy);
+}
+
+}  // namespace core
+}  // namespace mengde
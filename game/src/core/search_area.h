@@ -0,0 +1,43 @@
+#ifndef MENGDE_CORE_SEARCH_AREA_H_
+#define MENGDE_CORE_SEARCH_AREA_H_
+
+#include "util/common.h"
+
+namespace mengde {
+namespace core {
+
+// SearchArea maps map coordinates to dense local indices for a path search
+//
+// It is either the whole map or the diamond of a radius around a pivot. Since every move cost is at least 1, a unit
+// cannot get out of the diamond of radius `move` around its position, so scratch buffers for a movement search only
+// need to cover that diamond regardless of the map size.
+// Local indices are assigned in row-major order in both shapes, hence comparing local indices gives the same order
+// as comparing map cell indices.
+
+class SearchArea {
+ public:
+  static SearchArea Whole(Vec2D map_size);
+  static SearchArea Diamond(Vec2D map_size, Vec2D pivot, int radius);
+
+ public:
+  int size() const { return size_; }
+  bool Contains(Vec2D) const;
+  int ToIndex(Vec2D) const;
+  Vec2D ToCoords(int) const;
+
+ private:
+  SearchArea(Vec2D map_size, Vec2D pivot, int radius);
+  bool IsWhole() const { return radius_ < 0; }
+  int RowOffset(int row) const;
+
+ private:
+  Vec2D map_size_;
+  Vec2D pivot_;
+  int radius_;  // Negative for the whole map
+  int size_;
+};
+
+}  // namespace core
+}  // namespace mengde
+
+#endif  // MENGDE_CORE_SEARCH_AREA_H_
@@ -1,5 +1,8 @@
 #include "stage.h"
 
+#include "ai_decision_cache.h"
+#include "ai_phase_plan.h"
+#include "ai_search.h"
 #include "assets.h"
 #include "cmd.h"
 #include "cmd_debug_printer.h"
@@ -11,8 +14,10 @@
 #include "lua_callbacks.h"
 #include "luab/ref.h"
 #include "magic.h"
+#include "movement_range_cache.h"
 #include "stage_unit_manager.h"
 #include "user_interface.h"
+#include "visual_event_recorder.h"
 #include "util/game_env.h"
 #include "util/path.h"
 
@@ -32,10 +37,24 @@ Stage::Stage(const ResourceManagers& rc, const Assets* assets, const Path& stage
       commander_{new Commander},
       deployer_{nullptr},
       map_{nullptr},
+      movement_range_cache_{nullptr},
+      ai_decision_cache_{nullptr},
       stage_unit_manager_{new StageUnitManager},
       turn_{GetTurnLimit()},
-      status_(Status::kDeploying) {
+      status_(Status::kDeploying),
+      revision_(0),
+      ai_planner_forces_(0),
+      ai_search_budget_(0),
+      user_controlled_(true),
+      seed_(0) {
+  Seed(0);
   map_ = std::unique_ptr<Map>(CreateMap());
+  movement_range_cache_ = std::make_unique<MovementRangeCache>(map_.get());
+  ai_decision_cache_ = std::make_unique<AIDecisionCache>(this);
+  map_->SetOnUnitChanged([this](Vec2D c) {
+    movement_range_cache_->OnUnitChanged(c);
+    revision_++;
+  });
 
   // Run main function
   lua_->Call<void>(string{"main"}, lua_this_);
@@ -146,11 +165,11 @@ void Stage::KillUnit(Unit* unit) {
 }
 
 bool Stage::TryBasicAttack(Unit* unit_atk, Unit* unit_def) {
-  return GenRandom(100) < Formulae::ComputeBasicAttackAccuracy(unit_atk, unit_def);
+  return rng_.Gen(100) < Formulae::ComputeBasicAttackAccuracy(unit_atk, unit_def);
 }
 
 bool Stage::TryMagic(Unit* unit_atk, Unit* unit_def) {
-  return GenRandom(100) < Formulae::ComputeMagicAccuracy(unit_atk, unit_def);
+  return rng_.Gen(100) < Formulae::ComputeMagicAccuracy(unit_atk, unit_def);
 }
 
 bool Stage::IsValidCoords(Vec2D c) const { return map_->IsValidCoords(c); }
@@ -188,7 +207,7 @@ bool Stage::EndForceTurn() {
   return IsUserTurn();
 }
 
-bool Stage::IsUserTurn() const { return turn_.force() == Force::kOwn; }
+bool Stage::IsUserTurn() const { return user_controlled_ && turn_.force() == Force::kOwn; }
 
 bool Stage::IsAITurn() const { return !IsUserTurn(); }
 
@@ -197,20 +216,13 @@ bool Stage::IsCurrentTurn(Unit* unit) const { return unit->force() == turn_.forc
 const Turn& Stage::GetTurn() const { return turn_; }
 
 vector<Vec2D> Stage::FindMovablePos(Unit* unit) {
-  std::unique_ptr<PathTree> path_tree{FindMovablePath(unit)};
-  auto list = path_tree->GetNodeList();
+  vector<Vec2D> list = movement_range_cache_->Get(unit);
 
   // Remove positions that another unit is present
-  // TODO Enhance this inefficient algorithm O(M * N) where
-  //      M is the number of res elements
-  //      N is the number of units in this stage
   list.erase(std::remove_if(list.begin(), list.end(),
                             [&](const Vec2D& e) {
-                              bool erase = false;
-                              ForEachUnit([&](const Unit* u) {
-                                erase = erase || (unit != u && !u->IsDead() && u->position() == e);
-                              });
-                              return erase;
+                              const Unit* u = GetUnitInCell(e);
+                              return u != nullptr && u != unit && !u->IsDead();
                             }),
              list.end());
 
@@ -246,6 +258,60 @@ void Stage::DoNext() {
   }
 #endif
   commander_->DoNext(this);
+  revision_++;
+}
+
+bool Stage::CanUndo() const { return commander_->CanUndo(); }
+
+bool Stage::CanRedo() const { return commander_->CanRedo(); }
+
+bool Stage::Undo() {
+  if (!commander_->Undo(this)) return false;
+  ai_phase_plan_ = nullptr;
+  revision_++;
+  return true;
+}
+
+bool Stage::Redo() {
+  if (!commander_->Redo(this)) return false;
+  ai_phase_plan_ = nullptr;
+  revision_++;
+  return true;
+}
+
+void Stage::SetCmdRecorder(CmdRecorder* recorder) { commander_->SetRecorder(recorder); }
+
+void Stage::SetAIPhasePlan(unique_ptr<AIPhasePlan> plan) { ai_phase_plan_ = std::move(plan); }
+
+void Stage::StartAISearch() {
+  ASSERT_GT(ai_search_budget_, 0);
+  // The next action is the one of the plan searched before, as long as it still fits
+  if (ai_phase_plan_ != nullptr && ai_phase_plan_->HasNext(this)) return;
+  ai_search_task_ = std::make_unique<AISearchTask>(this, ai_search_budget_);
+}
+
+bool Stage::IsAISearchDone() const { return ai_search_task_ == nullptr || ai_search_task_->IsDone(); }
+
+unique_ptr<AISearchTask> Stage::TakeAISearch() {
+  // A search started at another revision would play units that may have moved or died since
+  if (ai_search_task_ != nullptr && ai_search_task_->revision() != revision_) {
+    ai_search_task_ = nullptr;
+  }
+  return std::move(ai_search_task_);
+}
+
+void Stage::PlayAIPhase(vector<VisualEvent>* events) {
+  ASSERT(IsAITurn());
+  VisualEventRecorder recorder{this, events};
+  while (status_ == Status::kUndecided) {
+    if (!HasNext()) user_interface_->PushPlayAI();
+
+    const Cmd* cmd = GetNextCmdConst();
+    const bool end_turn = (cmd->op() == Cmd::Op::kCmdEndTurn);
+    if (events != nullptr) cmd->Accept(recorder);
+    DoNext();
+    if (end_turn) break;
+  }
 }
 
 void Stage::Push(unique_ptr<Cmd> cmd) {
@@ -333,6 +399,20 @@ void Stage::UnregisterEvent(uint32_t id) { return lua_callbacks_->UnregisterEven
 
 void Stage::SetAIMode(const UId& uid, AIMode ai_mode) { stage_unit_manager_->SetAIMode(uid, ai_mode); }
 
+void Stage::SetAIPlanner(Force force, bool enabled) {
+  if (enabled) {
+    ai_planner_forces_ |= static_cast<uint32_t>(force);
+  } else {
+    ai_planner_forces_ &= ~static_cast<uint32_t>(force);
+  }
+}
+
+void Stage::SetAISearchBudget(int budget_ms) { ai_search_budget_ = budget_ms; }
+
+void Stage::SetUserControlled(bool user_controlled) { user_controlled_ = user_controlled; }
+
+bool Stage::UsesAIPlanner(Force force) const { return ai_planner_forces_ & static_cast<uint32_t>(force); }
+
 void Stage::RunEvents() { return lua_callbacks_->RunEvents(lua_this()); }
 
 bool Stage::SubmitDeploy() {
@@ -349,6 +429,7 @@ bool Stage::SubmitDeploy() {
 
   status_ = Status::kUndecided;
   lua_->Call<void>(lua_callbacks_->on_begin(), lua_this_);
+  revision_++;
   return true;
 }
 
@@ -360,5 +441,12 @@ uint32_t Stage::FindDeploy(const Hero* hero) { return deployer_->Find(hero); }
 
 const IAIUnit* Stage::GetAIUnit(const UId& uid) const { return stage_unit_manager_->GetAIUnit(uid); }
 
+void Stage::Seed(uint64_t seed) {
+  seed_ = seed;
+  // The combat stream is the one of the seed itself, and the AI stream is jumped ahead of it
+  ai_rng_.Seed(seed);
+  rng_ = ai_rng_.Split();
+}
+
 }  // namespace core
 }  // namespace mengde
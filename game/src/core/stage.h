@@ -15,6 +15,7 @@
 #include "turn.h"
 #include "unit.h"
 #include "util/common.h"
+#include "util/rng.h"
 
 class Path;
 
@@ -26,15 +27,21 @@ class Ref;
 namespace mengde {
 namespace core {
 
+class AIDecisionCache;
+class AIPhasePlan;
+class AISearchTask;
 class Assets;
 class Cmd;
+class CmdRecorder;
 class Commander;
 class LuaCallbacks;
 class Magic;
 class Deployer;
+class MovementRangeCache;
 class StageUnitManager;
 class UnitSupervisor;
 class UserInterface;
+struct VisualEvent;
 
 class Stage : public IDeployHelper {
  public:
@@ -65,6 +72,18 @@ class Stage : public IDeployHelper {
   void DoNext();
   void Push(unique_ptr<Cmd>);
   const Cmd* GetNextCmdConst() const;
+  bool CanUndo() const;
+  bool CanRedo() const;
+  bool Undo();
+  bool Redo();
+  void SetCmdRecorder(CmdRecorder* recorder);
+  uint32_t revision() const { return revision_; }
+  void StartAISearch();
+  bool IsAISearchDone() const;
+  unique_ptr<AISearchTask> TakeAISearch();
+  AIPhasePlan* ai_phase_plan() { return ai_phase_plan_.get(); }
+  void SetAIPhasePlan(unique_ptr<AIPhasePlan> plan);
+  void PlayAIPhase(vector<VisualEvent>* events);
 
   // General //
   Magic* LookupMagic(const std::string&);
@@ -77,7 +96,10 @@ class Stage : public IDeployHelper {
   bool IsCurrentTurn(Unit*) const;
   bool IsAITurn() const;
   bool IsUserTurn() const;
+  bool UsesAIPlanner(Force force) const;
+  int ai_search_budget() const { return ai_search_budget_; }
   const Turn& GetTurn() const;
+  void RestoreTurn(const Turn& turn) { turn_ = turn; }  // For StateHistory
   bool UnitInCell(Vec2D) const;
   const Unit* GetUnitInCell(Vec2D) const;
   const Cell* GetCell(Vec2D) const;
@@ -85,9 +107,15 @@ class Stage : public IDeployHelper {
   uint32_t GetNumOwnsAlive();
   bool CheckStatus();
   Status GetStatus() { return status_; }
+  void RestoreStatus(Status status) { status_ = status; }  // For StateHistory
   Assets* assets() { return assets_.get(); }
   unique_ptr<Assets>&& ReturnAssets() { return std::move(assets_); }
   const IAIUnit* GetAIUnit(const UId& uid) const;
+  AIDecisionCache* ai_decision_cache() { return ai_decision_cache_.get(); }
+  void Seed(uint64_t seed);
+  uint64_t seed() const { return seed_; }
+  Rng* rng() { return &rng_; }
+  Rng* ai_rng() { return &ai_rng_; }
 
   // IDeployHelper interfaces
   bool SubmitDeploy() override;
@@ -108,6 +136,9 @@ class Stage : public IDeployHelper {
   void SetOnDefeat(const luab::Ref& ref);
   void SetEndCondition(const luab::Ref& ref);
   void SetAIMode(const UId& uid, AIMode ai_mode);
+  void SetAIPlanner(Force force, bool enabled);
+  void SetAISearchBudget(int budget_ms);
+  void SetUserControlled(bool user_controlled);
 
   uint32_t RegisterEvent(const luab::Ref& condition, const luab::Ref& handler);
   void UnregisterEvent(uint32_t id);
@@ -143,9 +174,22 @@ class Stage : public IDeployHelper {
   std::unique_ptr<Commander> commander_;
   std::unique_ptr<Deployer> deployer_;
   std::unique_ptr<Map> map_;
+  std::unique_ptr<MovementRangeCache> movement_range_cache_;
+  std::unique_ptr<AIDecisionCache> ai_decision_cache_;
   std::unique_ptr<StageUnitManager> stage_unit_manager_;
   Turn turn_;
   Status status_;
+  uint32_t revision_;           // Bumped whenever the stage state may have changed
+  uint32_t ai_planner_forces_;  // Forces whose phases are planned by AIPlanner
+  int ai_search_budget_;        // In milliseconds, AISearch replaces AIPlanner if positive
+  bool user_controlled_;        // Whether the user plays the own force, otherwise AI plays every force
+  uint64_t seed_;               // Every random decision of the stage comes from this
+  Rng rng_;                     // Hits, criticals and the like
+  Rng ai_rng_;                  // Decisions of AIs, `rng_` split off it so a replay that does not run AI rolls the same
+  // Rest of the phase AIPlanner or AISearch planned last, may be nullptr
+  unique_ptr<AIPhasePlan> ai_phase_plan_;
+  // Declared last so the worker is stopped before anything it reads goes away
+  unique_ptr<AISearchTask> ai_search_task_;
 };
 
 }  // namespace core
@@ -34,6 +34,16 @@ void StatModifierList::AddModifier(StatModifier* m) {
   elements_.push_back(m);
 }
 
+void StatModifierList::Assign(const std::vector<StatModifier>& modifiers) {
+  for (auto e : elements_) {
+    delete e;
+  }
+  elements_.clear();
+  for (const auto& m : modifiers) {
+    elements_.push_back(new StatModifier(m));
+  }
+}
+
 void StatModifierList::NextTurn() {
   util::std::VectorEraseIf(elements_, [](StatModifier* m) -> bool {
     bool remove = (m->turn().left() == 0);
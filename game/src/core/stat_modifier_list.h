@@ -16,6 +16,7 @@ class StatModifierList {
   StatModifierList();
   ~StatModifierList();
   void AddModifier(StatModifier *);
+  void Assign(const std::vector<StatModifier> &modifiers);
   void NextTurn();
   Attribute CalcAddends() const;
   Attribute CalcMultipliers() const;
@@ -0,0 +1,285 @@
+#include "state_history.h"
+
+#include "cmds.h"
+#include "stage.h"
+#include "unit.h"
+
+namespace mengde {
+namespace core {
+
+namespace {
+
+void AddUnit(vector<UId>* uids, const UId& uid) {
+  if (uid && std::find(uids->begin(), uids->end(), uid) == uids->end()) uids->push_back(uid);
+}
+
+// Gets the units a Cmd is about, or returns false if it may change any unit
+bool GetNamedUnits(const Cmd& cmd, vector<UId>* uids) {
+  switch (cmd.op()) {
+    case Cmd::Op::kCmdAction: {
+      const CmdAction& action = static_cast<const CmdAction&>(cmd);
+      if (action.cmd_move() != nullptr) AddUnit(uids, action.cmd_move()->GetUnit());
+      if (action.cmd_act() != nullptr) {
+        AddUnit(uids, action.cmd_act()->GetUnitAtk());
+        AddUnit(uids, action.cmd_act()->GetUnitDef());
+      }
+      return true;
+    }
+    case Cmd::Op::kCmdMove:
+    case Cmd::Op::kCmdKilled:
+    case Cmd::Op::kCmdRestoreHp:
+    case Cmd::Op::kCmdGainExp:
+    case Cmd::Op::kCmdLevelUp:
+    case Cmd::Op::kCmdPromote:
+      AddUnit(uids, static_cast<const CmdUnit&>(cmd).GetUnit());
+      return true;
+    case Cmd::Op::kCmdStay:
+    case Cmd::Op::kCmdMagic:
+    case Cmd::Op::kCmdHit:
+    case Cmd::Op::kCmdMiss:
+      AddUnit(uids, static_cast<const CmdTwoUnits&>(cmd).GetUnitAtk());
+      AddUnit(uids, static_cast<const CmdTwoUnits&>(cmd).GetUnitDef());
+      return true;
+    case Cmd::Op::kCmdSpeak:
+      return true;
+    default:
+      return false;
+  }
+}
+
+uint32_t CountUnits(const Stage* stage) {
+  uint32_t count = 0;
+  stage->ForEachUnitConst([&count](const Unit*) { count++; });
+  return count;
+}
+
+int32_t Pack(int hi, int lo) { return static_cast<int32_t>((static_cast<uint32_t>(hi) << 16) | (lo & 0xffff)); }
+
+int UnpackHi(int32_t value) { return static_cast<int16_t>(static_cast<uint32_t>(value) >> 16); }
+
+int UnpackLo(int32_t value) { return static_cast<int16_t>(value & 0xffff); }
+
+int32_t PackTurn(const Turn& turn) { return Pack(turn.current(), static_cast<int>(turn.force())); }
+
+bool IsSame(const vector<StatModifier>& lhs, const vector<StatModifier>& rhs) {
+  return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), [](const StatModifier& l, const StatModifier& r) {
+    return l.id() == r.id() && l.stat_id() == r.stat_id() && l.addend() == r.addend() &&
+           l.multiplier() == r.multiplier() && l.turn().left() == r.turn().left();
+  });
+}
+
+}  // namespace
+
+const uint32_t StateHistory::kMaxSteps;
+
+StateHistory::StateHistory()
+    : head_(0),
+      num_undo_(0),
+      num_redo_(0),
+      recording_(false),
+      num_units_before_(0),
+      turn_before_(0),
+      status_before_(0) {}
+
+void StateHistory::Begin(Stage* stage, const Cmd& cmd) {
+  if (!recording_) {
+    Step& step = steps_[head_];
+    step.deltas.clear();
+    step.modifiers.clear();
+    step.classes.clear();
+    head_ = (head_ + 1) % kMaxSteps;
+    num_undo_ = std::min(num_undo_ + 1, kMaxSteps);  // The oldest step is overwritten once the ring is full
+    num_redo_ = 0;
+    recording_ = true;
+    num_units_before_ = CountUnits(stage);
+  }
+
+  uids_.clear();
+  if (!GetNamedUnits(cmd, &uids_)) {
+    stage->ForEachUnit([this](Unit* unit) { uids_.push_back(unit->uid()); });
+  }
+  before_.resize(uids_.size());
+  for (uint32_t i = 0; i < uids_.size(); i++) {
+    Capture(stage, stage->LookupUnit(uids_[i]), &before_[i]);
+  }
+  turn_before_ = PackTurn(stage->GetTurn());
+  status_before_ = static_cast<int32_t>(stage->GetStatus());
+}
+
+void StateHistory::End(Stage* stage, bool idle) {
+  ASSERT(recording_);
+  const uint32_t current = (head_ + kMaxSteps - 1) % kMaxSteps;
+  Step& step = steps_[current];
+  for (uint32_t i = 0; i < uids_.size(); i++) {
+    Capture(stage, stage->LookupUnit(uids_[i]), &after_);
+    Compare(uids_[i], before_[i], after_, &step);
+  }
+  const int32_t turn_after = PackTurn(stage->GetTurn());
+  if (turn_after != turn_before_) {
+    step.deltas.push_back({StateDelta::Field::kTurn, 0, UId{}, turn_before_, turn_after});
+  }
+  const int32_t status_after = static_cast<int32_t>(stage->GetStatus());
+  if (status_after != status_before_) {
+    step.deltas.push_back({StateDelta::Field::kStatus, 0, UId{}, status_before_, status_after});
+  }
+
+  if (idle) {
+    recording_ = false;
+    if (CountUnits(stage) != num_units_before_) {
+      // Units were generated, which taking back this step or any before it could put on the same cell as them
+      num_undo_ = 0;
+    } else if (step.deltas.empty()) {
+      // Nothing to take back
+      head_ = current;
+      num_undo_--;
+    }
+  }
+}
+
+bool StateHistory::Undo(Stage* stage) {
+  if (!CanUndo()) return false;
+  head_ = (head_ + kMaxSteps - 1) % kMaxSteps;
+  const Step& step = steps_[head_];
+  for (auto itr = step.deltas.rbegin(); itr != step.deltas.rend(); itr++) {
+    Apply(stage, step, *itr, itr->before);
+  }
+  num_undo_--;
+  num_redo_++;
+  return true;
+}
+
+bool StateHistory::Redo(Stage* stage) {
+  if (!CanRedo()) return false;
+  const Step& step = steps_[head_];
+  for (const StateDelta& delta : step.deltas) {
+    Apply(stage, step, delta, delta.after);
+  }
+  head_ = (head_ + 1) % kMaxSteps;
+  num_undo_++;
+  num_redo_--;
+  return true;
+}
+
+void StateHistory::Capture(Stage* stage, const Unit* unit, UnitState* state) const {
+  state->hp = unit->GetCurrentHpMp().hp;
+  state->mp = unit->GetCurrentHpMp().mp;
+  state->direction = unit->direction();
+  state->done_action = unit->IsDoneAction();
+  state->level = unit->GetLevel();
+  state->exp = unit->GetExp();
+  state->unit_class = unit->unit_class();
+  std::fill(state->conditions, state->conditions + kNumConditions, -1);
+  unit->condition_set().Iterate(
+      [state](Condition condition, TurnBased turns) { state->conditions[static_cast<int>(condition)] = turns.left(); });
+  state->modifiers.clear();
+  unit->volatile_attribute().stat_modifier_list().iterate(
+      [state](const StatModifier& modifier) { state->modifiers.push_back(modifier); });
+  state->placed = (stage->GetUnitInCell(unit->position()) == unit);
+  state->position = unit->position();
+}
+
+// Deltas of a unit are in the order they are applied when done again, and the other way around when taken back
+void StateHistory::Compare(const UId& uid, const UnitState& before, const UnitState& after, Step* step) const {
+  auto add = [&](StateDelta::Field field, uint8_t index, int32_t b, int32_t a) {
+    if (b != a) step->deltas.push_back({field, index, uid, b, a});
+  };
+  add(StateDelta::Field::kHp, 0, before.hp, after.hp);
+  add(StateDelta::Field::kMp, 0, before.mp, after.mp);
+  add(StateDelta::Field::kDirection, 0, before.direction, after.direction);
+  add(StateDelta::Field::kDoneAction, 0, before.done_action, after.done_action);
+  add(StateDelta::Field::kLevel, 0, Pack(before.level, before.exp), Pack(after.level, after.exp));
+  if (before.unit_class != after.unit_class) {
+    const int32_t index = step->classes.size();
+    step->classes.push_back(before.unit_class);
+    step->classes.push_back(after.unit_class);
+    add(StateDelta::Field::kClass, 0, index, index + 1);
+  }
+  for (int c = 0; c < kNumConditions; c++) {
+    add(StateDelta::Field::kCondition, c, before.conditions[c], after.conditions[c]);
+  }
+  if (!IsSame(before.modifiers, after.modifiers)) {
+    const int32_t index = step->modifiers.size();
+    step->modifiers.push_back(before.modifiers);
+    step->modifiers.push_back(after.modifiers);
+    add(StateDelta::Field::kModifiers, 0, index, index + 1);
+  }
+  // A killed unit is removed from the map where it is, and a unit is moved only while it is on the map
+  add(StateDelta::Field::kPlaced, 0, before.placed, after.placed);
+  add(StateDelta::Field::kPosition, 0, Pack(before.position.x, before.position.y),
+      Pack(after.position.x, after.position.y));
+}
+
+void StateHistory::Apply(Stage* stage, const Step& step, const StateDelta& delta, int32_t value) const {
+  if (delta.field == StateDelta::Field::kTurn) {
+    const Turn& turn = stage->GetTurn();
+    stage->RestoreTurn(Turn{turn.limit(), static_cast<uint16_t>(UnpackHi(value)), static_cast<Force>(UnpackLo(value))});
+    return;
+  }
+  if (delta.field == StateDelta::Field::kStatus) {
+    stage->RestoreStatus(static_cast<Stage::Status>(value));
+    return;
+  }
+
+  Unit* unit = stage->LookupUnit(delta.uid);
+  switch (delta.field) {
+    case StateDelta::Field::kHp: {
+      HpMp hpmp = unit->GetCurrentHpMp();
+      hpmp.hp = value;
+      unit->current_hpmp(hpmp);
+      break;
+    }
+    case StateDelta::Field::kMp: {
+      HpMp hpmp = unit->GetCurrentHpMp();
+      hpmp.mp = value;
+      unit->current_hpmp(hpmp);
+      break;
+    }
+    case StateDelta::Field::kDirection:
+      unit->direction(static_cast<Direction>(value));
+      break;
+    case StateDelta::Field::kDoneAction:
+      if (value) {
+        unit->EndAction();
+      } else {
+        unit->ResetAction();
+      }
+      break;
+    case StateDelta::Field::kLevel:
+      unit->SetClassAndLevel(unit->unit_class(), Level(UnpackHi(value), UnpackLo(value)));
+      break;
+    case StateDelta::Field::kClass:
+      unit->SetClassAndLevel(step.classes[value], Level(unit->GetLevel(), unit->GetExp()));
+      break;
+    case StateDelta::Field::kCondition: {
+      const Condition condition = static_cast<Condition>(delta.index);
+      unit->condition_set().Unset(condition);
+      if (value >= 0) unit->condition_set().Set(condition, TurnBased(value));
+      break;
+    }
+    case StateDelta::Field::kModifiers:
+      unit->SetStatModifiers(step.modifiers[value]);
+      break;
+    case StateDelta::Field::kPlaced:
+      if (value) {
+        stage->GetMap()->PlaceUnit(delta.uid, unit->position());
+      } else {
+        stage->GetMap()->RemoveUnit(unit->position());
+      }
+      break;
+    case StateDelta::Field::kPosition: {
+      const Vec2D pos{UnpackHi(value), UnpackLo(value)};
+      if (stage->GetUnitInCell(unit->position()) == unit) {
+        stage->MoveUnit(unit, pos);
+      } else {
+        unit->position(pos);
+      }
+      break;
+    }
+    default:
+      UNREACHABLE("Invalid StateDelta::Field");
+      break;
+  }
+}
+
+}  // namespace core
+}  // namespace mengde
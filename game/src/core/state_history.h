@@ -0,0 +1,113 @@
+#ifndef MENGDE_CORE_STATE_HISTORY_H_
+#define MENGDE_CORE_STATE_HISTORY_H_
+
+#include "condition.h"
+#include "id.h"
+#include "stat_modifier.h"
+#include "util/common.h"
+#include "util/direction.h"
+
+namespace mengde {
+namespace core {
+
+class Cmd;
+class HeroClass;
+class Stage;
+class Unit;
+
+// StateDelta is a change of one field of a unit, or of the turn or the status of the stage, that a Cmd made
+
+struct StateDelta {
+  enum class Field : uint8_t {
+    kHp,
+    kMp,
+    kDirection,
+    kDoneAction,
+    kLevel,      // Level and exp
+    kClass,      // Index of `StateHistory::Step::classes`
+    kCondition,  // Turns left of the condition `index`, -1 if it is not set
+    kModifiers,  // Index of `StateHistory::Step::modifiers`
+    kPlaced,     // On the map, which a killed unit is not
+    kPosition,
+    kTurn,
+    kStatus
+  };
+
+  Field field;
+  uint8_t index;
+  UId uid;  // None for kTurn and kStatus
+  int32_t before;
+  int32_t after;
+};
+
+// StateHistory keeps what the Cmds done recently changed, so Commander can take them back and do them again
+//
+// Deltas are grouped in steps, a step being everything done from when a Cmd is pushed to an empty queue until the
+// queue is empty again, like an action with its attacks, counter-attack and exp. Steps are kept in a ring buffer of the
+// last `kMaxSteps`, and taking one back or doing it again only applies its deltas, with no Cmd done.
+//
+// A Cmd is expected to change only the units it names. Cmds that are not about units and CmdEndAction, which runs the
+// events of the Lua script, are checked against every unit. Units generated by a step are not taken back, so neither
+// that step nor any before it can be taken back once it is over. What the Lua script keeps by itself is not taken back
+// either.
+
+class StateHistory {
+ public:
+  static const uint32_t kMaxSteps = 32;
+
+ public:
+  StateHistory();
+  void Begin(Stage* stage, const Cmd& cmd);
+  void End(Stage* stage, bool idle);
+  bool CanUndo() const { return !recording_ && num_undo_ > 0; }
+  bool CanRedo() const { return !recording_ && num_redo_ > 0; }
+  bool Undo(Stage* stage);
+  bool Redo(Stage* stage);
+
+ private:
+  static const int kNumConditions = static_cast<int>(Condition::kRooted) + 1;
+
+  struct UnitState {
+    int hp;
+    int mp;
+    Direction direction;
+    bool done_action;
+    uint16_t level;
+    uint16_t exp;
+    const HeroClass* unit_class;
+    int32_t conditions[kNumConditions];  // Turns left, -1 if not set
+    vector<StatModifier> modifiers;
+    bool placed;
+    Vec2D position;
+  };
+
+  struct Step {
+    vector<StateDelta> deltas;
+    vector<vector<StatModifier>> modifiers;
+    vector<const HeroClass*> classes;
+  };
+
+ private:
+  void Capture(Stage* stage, const Unit* unit, UnitState* state) const;
+  void Compare(const UId& uid, const UnitState& before, const UnitState& after, Step* step) const;
+  void Apply(Stage* stage, const Step& step, const StateDelta& delta, int32_t value) const;
+
+ private:
+  Step steps_[kMaxSteps];
+  uint32_t head_;              // Where the next step goes
+  uint32_t num_undo_;          // Steps before `head_` that can be taken back
+  uint32_t num_redo_;          // Steps from `head_` that can be done again
+  bool recording_;             // The step before `head_` is not over
+  uint32_t num_units_before_;  // Units there were when the step before `head_` began
+  // Reused for every Cmd
+  vector<UId> uids_;
+  vector<UnitState> before_;
+  UnitState after_;
+  int32_t turn_before_;
+  int32_t status_before_;
+};
+
+}  // namespace core
+}  // namespace mengde
+
+#endif  // MENGDE_CORE_STATE_HISTORY_H_
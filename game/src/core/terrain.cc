@@ -18,7 +18,7 @@ void Terrain::SetIndex(int i) {
   index_ = i;
 }
 
-int Terrain::GetMoveCost(int class_idx) {
+int Terrain::GetMoveCost(int class_idx) const {
   ASSERT(class_idx < (int)move_costs_.size());
   return move_costs_[class_idx];
 }
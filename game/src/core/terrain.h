@@ -13,7 +13,8 @@ class Terrain {
   int GetIndex();
   void SetIndex(int);
   const std::string& id() const { return id_; }
-  int GetMoveCost(int);
+  int GetMoveCost(int) const;
+  int GetNumClasses() const { return move_costs_.size(); }
   int GetEffect(int);
 
  private:
@@ -0,0 +1,84 @@
+#include "threat_map.h"
+
+#include "map.h"
+#include "stage.h"
+#include "unit.h"
+#include "util/thread_pool.h"
+
+namespace mengde {
+namespace core {
+
+namespace {
+
+struct Coverage {
+  vector<int> reach;
+  vector<int> attack;
+};
+
+void Evaluate(Stage* stage, const Unit* unit, Coverage* coverage) {
+  if (unit->condition_set().Has(Condition::kStunned)) return;
+
+  Map* map = stage->GetMap();
+  vector<Vec2D> cells;
+  if (unit->condition_set().Has(Condition::kRooted)) {
+    cells.push_back(unit->position());
+  } else {
+    map->FindMovablePos(unit->uid(), &cells);
+  }
+
+  for (auto c : cells) {
+    // A unit can pass through but not stop at a cell occupied by another unit
+    const Unit* u = stage->GetUnitInCell(c);
+    if (u != nullptr && u != unit && !u->IsDead()) continue;
+
+    coverage->reach.push_back(map->SerializeVec2D(c));
+    unit->attack_range().ForEach(
+        [&](Vec2D pos) {
+          if (map->IsValidCoords(pos)) coverage->attack.push_back(map->SerializeVec2D(pos));
+        },
+        c);
+  }
+
+  // A unit counts once for a cell however many cells it can attack the cell from
+  std::sort(coverage->attack.begin(), coverage->attack.end());
+  coverage->attack.erase(std::unique(coverage->attack.begin(), coverage->attack.end()), coverage->attack.end());
+}
+
+}  // namespace
+
+ThreatMap::ThreatMap(Stage* stage, Force force, bool parallel) : force_(force), size_(stage->GetMapSize()) {
+  const Map* map = stage->GetMap();
+  vector<const Unit*> units;
+  stage->ForEachUnitConst([&](const Unit* unit) {
+    if (unit->force() != force || unit->IsDead()) return;
+    if (!map->UnitInCell(unit->position()) || map->GetUnitId(unit->position()) != unit->uid()) return;
+    units.push_back(unit);
+  });
+
+  vector<Coverage> coverages(units.size());
+  auto evaluate = [&](int i) { Evaluate(stage, units[i], &coverages[i]); };
+  if (parallel) {
+    ThreadPool::GetInstance()->ParallelFor(units.size(), evaluate);
+  } else {
+    for (uint32_t i = 0; i < units.size(); i++) evaluate(i);
+  }
+
+  reachable_.assign(size_.x * size_.y, false);
+  num_threats_.assign(size_.x * size_.y, 0);
+  for (auto& coverage : coverages) {
+    for (int cell : coverage.reach) reachable_[cell] = true;
+    for (int cell : coverage.attack) num_threats_[cell]++;
+  }
+}
+
+int ThreatMap::ToIndex(Vec2D c) const {
+  ASSERT(0 <= c.x && c.x < size_.x && 0 <= c.y && c.y < size_.y);
+  return c.y * size_.x + c.x;
+}
+
+bool ThreatMap::IsReachable(Vec2D c) const { return reachable_[ToIndex(c)]; }
+
+int ThreatMap::GetNumThreats(Vec2D c) const { return num_threats_[ToIndex(c)]; }
+
+}  // namespace core
+}  // namespace mengde
@@ -0,0 +1,40 @@
+#ifndef MENGDE_CORE_THREAT_MAP_H_
+#define MENGDE_CORE_THREAT_MAP_H_
+
+#include "force.h"
+#include "util/common.h"
+
+namespace mengde {
+namespace core {
+
+class Stage;
+
+// ThreatMap is the combined coverage of all units of a force for the current turn
+//
+// A cell is reachable if any unit of the force can move to it, and threatened if any unit can attack it after moving,
+// which is what AI risk evaluation, danger zone display and scripts ask for. Units are evaluated independently and
+// their coverages are merged afterwards, so they can be evaluated in parallel with `parallel` set.
+// Stunned units cover nothing and rooted units cover only what they can reach from their position.
+
+class ThreatMap {
+ public:
+  ThreatMap(Stage* stage, Force force, bool parallel = false);
+  Force force() const { return force_; }
+  bool IsReachable(Vec2D) const;
+  bool IsThreatened(Vec2D c) const { return GetNumThreats(c) > 0; }
+  int GetNumThreats(Vec2D) const;
+
+ private:
+  int ToIndex(Vec2D) const;
+
+ private:
+  Force force_;
+  Vec2D size_;
+  vector<bool> reachable_;
+  vector<uint16_t> num_threats_;  // Number of units that can attack each cell
+};
+
+}  // namespace core
+}  // namespace mengde
+
+#endif  // MENGDE_CORE_THREAT_MAP_H_
@@ -3,7 +3,7 @@
 namespace mengde {
 namespace core {
 
-Turn::Turn(uint16_t limit, uint16_t current) : current_{current}, limit_{limit}, force_{Force::kFirst} {}
+Turn::Turn(uint16_t limit, uint16_t current, Force force) : current_{current}, limit_{limit}, force_{force} {}
 
 bool Turn::Next() {
   Force next = static_cast<Force>((uint32_t)force_ << 1);
@@ -8,7 +8,7 @@ namespace core {
 
 class Turn {
  public:
-  Turn(uint16_t limit, uint16_t current = 1);
+  Turn(uint16_t limit, uint16_t current = 1, Force force = Force::kFirst);
   bool Next();
   uint16_t current() const { return current_; }
   uint16_t limit() const { return limit_; }
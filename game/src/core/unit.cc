@@ -36,12 +36,7 @@ void Unit::RestoreHP(int amount) { Heal(amount); }
 
 void Unit::Heal(int amount) { current_hpmp_.hp = std::min(current_hpmp_.hp + amount, GetOriginalHpMp().hp); }
 
-bool Unit::IsHostile(const Unit* u) const {
-  Force uforce = u->force_;
-  if (((uint32_t)force_ & (uint32_t)Force::kFriendly) && ((uint32_t)uforce & (uint32_t)Force::kEnemy)) return true;
-  if (((uint32_t)uforce & (uint32_t)Force::kFriendly) && ((uint32_t)force_ & (uint32_t)Force::kEnemy)) return true;
-  return false;
-}
+bool Unit::IsHostile(const Unit* u) const { return core::IsHostile(force_, u->force_); }
 
 string Unit::id() const { return hero_->id(); }
 
@@ -77,6 +72,11 @@ void Unit::AddStatModifier(StatModifier* sm) {
   UpdateStat();
 }
 
+void Unit::SetStatModifiers(const vector<StatModifier>& modifiers) {
+  volatile_attribute_.stat_modifier_list().Assign(modifiers);
+  UpdateStat();
+}
+
 bool Unit::IsHPLow() const { return GetCurrentHpMp().hp <= GetOriginalHpMp().hp * 3 / 10; }
 
 bool Unit::IsDead() const { return GetCurrentHpMp().hp <= 0; }
@@ -120,6 +120,11 @@ void Unit::Promote(const UnitClassManager* ucm) {
   UpdateStat();
 }
 
+void Unit::SetClassAndLevel(const HeroClass* unit_class, const Level& level) {
+  hero_->SetClassAndLevel(unit_class, level);
+  UpdateStat();
+}
+
 void Unit::EndAction() { done_action_ = true; }
 
 void Unit::ResetAction() { done_action_ = false; }
@@ -134,9 +139,16 @@ void Unit::RaiseEvent(event::OnCmdEvent type, Unit* unit, CmdAct* act) const {
   equipment_set_->RaiseEvent(type, unit, act);
 }
 
+void Unit::RaiseEvent(event::OnCmdEvent type, const Unit* unit, BasicAttackModifier* modifier) const {
+  ASSERT(unit == this);
+  equipment_set_->RaiseEvent(type, unit, modifier);
+}
+
 unique_ptr<Cmd> Unit::RaiseEvent(event::GeneralEvent type) { return RaiseEvent(type, this); }
 
 void Unit::RaiseEvent(event::OnCmdEvent type, CmdAct* act) { RaiseEvent(type, this, act); }
 
+void Unit::RaiseEvent(event::OnCmdEvent type, BasicAttackModifier* modifier) const { RaiseEvent(type, this, modifier); }
+
 }  // namespace core
 }  // namespace mengde
@@ -30,8 +30,10 @@ class Unit : public IUnitBase, public IEvent, public IEquipper {
   // IEvent interfaces and wrappers
   virtual unique_ptr<Cmd> RaiseEvent(event::GeneralEvent, Unit*) const override;
   virtual void RaiseEvent(event::OnCmdEvent, Unit*, CmdAct*) const override;
+  virtual void RaiseEvent(event::OnCmdEvent, const Unit*, BasicAttackModifier*) const override;
   unique_ptr<Cmd> RaiseEvent(event::GeneralEvent);
   void RaiseEvent(event::OnCmdEvent, CmdAct*);
+  void RaiseEvent(event::OnCmdEvent, BasicAttackModifier*) const;
 
  public:
   // IUnitBase interfaces
@@ -53,6 +55,7 @@ class Unit : public IUnitBase, public IEvent, public IEquipper {
   void uid(const UId& uid) { uid_ = uid; }
   UId uid() const { return uid_; }
   uint16_t max_exp() { return Level::kExpLimit; }
+  void current_hpmp(const HpMp& hpmp) { current_hpmp_ = hpmp; }
   void position(Vec2D pos) { position_ = pos; }
   Vec2D position() const { return position_; }
   void direction(Direction direction) { direction_ = direction; }
@@ -65,6 +68,7 @@ class Unit : public IUnitBase, public IEvent, public IEquipper {
 
  public:
   void AddStatModifier(StatModifier*);
+  void SetStatModifiers(const vector<StatModifier>& modifiers);
   void AddEventEffect(EventEffect*);
   bool IsHPLow() const;
   bool IsDead() const;
@@ -80,6 +84,7 @@ class Unit : public IUnitBase, public IEvent, public IEquipper {
   void LevelUp();
   bool ReadyPromotion() const;
   void Promote(const UnitClassManager* ucm);
+  void SetClassAndLevel(const HeroClass* unit_class, const Level& level);
   void EndAction();
   void ResetAction();
   void NextTurn();
@@ -4,6 +4,7 @@
 #include "cmd.h"
 #include "magic_list.h"
 #include "path_tree.h"
+#include "query_session.h"
 #include "stage.h"
 #include "turn.h"
 #include "unit.h"
@@ -16,22 +17,24 @@ namespace core {
 //
 
 AvailableUnits::AvailableUnits(Stage* stage) {
+  auto units = std::make_shared<vector<std::pair<UId, Vec2D>>>();
   stage->ForEachUnitConst([&](const Unit* unit) {
-    if (unit->force() == stage->GetCurrentForce() && !unit->IsDoneAction()) {
-      units_.push_back(std::make_pair(unit->uid(), unit->position()));
+    if (unit->force() == stage->GetCurrentForce() && !unit->IsDoneAction() && !unit->IsDead()) {
+      units->push_back(std::make_pair(unit->uid(), unit->position()));
     }
   });
+  units_ = units;
 }
 
-UId AvailableUnits::Get(const UnitKey& ukey) {
+UId AvailableUnits::Get(const UnitKey& ukey) const {
   ASSERT(ukey);
-  ASSERT_LE(ukey.Value(), units_.size());
-  return units_[ukey.Value()].first;
+  ASSERT_LE(ukey.Value(), units_->size());
+  return (*units_)[ukey.Value()].first;
 }
 
-UnitKey AvailableUnits::FindByPos(Vec2D pos) {
+UnitKey AvailableUnits::FindByPos(Vec2D pos) const {
   uint32_t idx = 0;
-  for (auto& e : units_) {
+  for (auto& e : *units_) {
     if (pos == e.second) {
       return UnitKey{idx};
     }
@@ -44,26 +47,25 @@ UnitKey AvailableUnits::FindByPos(Vec2D pos) {
 // AvailableMoves
 //
 
-AvailableMoves::AvailableMoves(Stage* stage, const UnitKey& ukey) {
-  auto uid = AvailableUnits(stage).Get(ukey);
+AvailableMoves::AvailableMoves(Stage* stage, const UId& uid) {
   Unit* unit = stage->LookupUnit(uid);
 
   if (unit->condition_set().Has(Condition::kStunned) || unit->condition_set().Has(Condition::kRooted)) {
-    moves_.push_back(unit->position());
+    moves_ = std::make_shared<vector<Vec2D>>(1, unit->position());
   } else {
-    moves_ = stage->FindMovablePos(unit);
+    moves_ = std::make_shared<vector<Vec2D>>(stage->FindMovablePos(unit));
   }
 }
 
-Vec2D AvailableMoves::Get(const MoveKey& mkey) {
+Vec2D AvailableMoves::Get(const MoveKey& mkey) const {
   ASSERT(mkey);
-  ASSERT_LE(mkey.Value(), moves_.size());
-  return moves_[mkey.Value()];
+  ASSERT_LE(mkey.Value(), moves_->size());
+  return (*moves_)[mkey.Value()];
 }
 
-void AvailableMoves::ForEach(const std::function<void(const MoveKey&, Vec2D)>& fn) {
-  for (uint32_t i = 0, size = moves_.size(); i < size; i++) {
-    fn(MoveKey{i}, moves_[i]);
+void AvailableMoves::ForEach(const std::function<void(const MoveKey&, Vec2D)>& fn) const {
+  for (uint32_t i = 0, size = moves_->size(); i < size; i++) {
+    fn(MoveKey{i}, (*moves_)[i]);
   }
 }
 
@@ -71,19 +73,16 @@ void AvailableMoves::ForEach(const std::function<void(const MoveKey&, Vec2D)>& f
 // AvailableActs
 //
 
-AvailableActs::AvailableActs(Stage* stage, const UnitKey& ukey, const MoveKey& move_id, ActionType type)
-    : stage_(stage), type_(type) {
-  UId uid = AvailableUnits(stage).Get(ukey);
-  Vec2D move_pos = AvailableMoves(stage, ukey).Get(move_id);
+AvailableActs::AvailableActs(Stage* stage, const UId& uid, Vec2D move_pos, ActionType type) : uid_(uid), type_(type) {
+  auto acts = std::make_shared<vector<Act>>();
 
   switch (type) {
     case ActionType::kStay:
-      acts_.push_back(std::make_unique<CmdStay>(uid));
+      acts->push_back({UId{}, move_pos, nullptr});
       break;
 
     case ActionType::kBasicAttack: {
-      auto atk_id = uid;
-      Unit* atk = stage_->LookupUnit(uid);
+      Unit* atk = stage->LookupUnit(uid);
 
       if (!atk->condition_set().Has(Condition::kStunned)) {
         atk->attack_range().ForEach(
@@ -91,7 +90,7 @@ AvailableActs::AvailableActs(Stage* stage, const UnitKey& ukey, const MoveKey& m
               if (!stage->IsValidCoords(pos)) return;
               auto def = stage->GetUnitInCell(pos);
               if (def != nullptr && atk->IsHostile(def)) {
-                acts_.push_back(std::make_unique<CmdBasicAttack>(atk_id, def->uid(), CmdBasicAttack::Type::kActive));
+                acts->push_back({def->uid(), pos, nullptr});
               }
             },
             move_pos);
@@ -100,8 +99,7 @@ AvailableActs::AvailableActs(Stage* stage, const UnitKey& ukey, const MoveKey& m
     }
 
     case ActionType::kMagic: {
-      auto atk_id = uid;
-      Unit* atk = stage_->LookupUnit(uid);
+      Unit* atk = stage->LookupUnit(uid);
 
       if (!atk->condition_set().Has(Condition::kStunned)) {
         MagicList magic_list(stage->magic_manager(), atk);
@@ -113,7 +111,7 @@ AvailableActs::AvailableActs(Stage* stage, const UnitKey& ukey, const MoveKey& m
                 if (!stage->IsValidCoords(pos)) return;
                 const Unit* def = stage->GetUnitInCell(pos);
                 if (def != nullptr && atk->IsHostile(def) == magic->is_target_enemy()) {
-                  acts_.push_back(std::make_unique<CmdMagic>(atk_id, def->uid(), magic));
+                  acts->push_back({def->uid(), pos, magic});
                 }
               },
               move_pos);
@@ -127,23 +125,39 @@ AvailableActs::AvailableActs(Stage* stage, const UnitKey& ukey, const MoveKey& m
       break;
   };
 
-  ASSERT(type != ActionType::kStay || acts_.size() == 1);
+  ASSERT(type != ActionType::kStay || acts->size() == 1);
+  acts_ = acts;
 }
 
-unique_ptr<CmdAct> AvailableActs::Get(const ActKey& akey) {
+unique_ptr<CmdAct> AvailableActs::Get(const ActKey& akey) const {
   ASSERT(akey);
-  ASSERT_LE(akey.Value(), acts_.size());
-  return std::move(acts_[akey.Value()]);
+  ASSERT_LE(akey.Value(), acts_->size());
+  const Act& act = (*acts_)[akey.Value()];
+  switch (type_) {
+    case ActionType::kStay:
+      return std::make_unique<CmdStay>(uid_);
+    case ActionType::kBasicAttack:
+      return std::make_unique<CmdBasicAttack>(uid_, act.target, CmdBasicAttack::Type::kActive);
+    case ActionType::kMagic:
+      return std::make_unique<CmdMagic>(uid_, act.target, act.magic);
+    default:
+      UNREACHABLE("Invalid ActionType");
+      return nullptr;
+  }
 }
 
-ActKey AvailableActs::Find(Vec2D pos) {
+Vec2D AvailableActs::GetTargetPos(const ActKey& akey) const {
+  ASSERT(akey);
+  ASSERT_LT(akey.Value(), acts_->size());
+  return (*acts_)[akey.Value()].target_pos;
+}
+
+ActKey AvailableActs::Find(Vec2D pos) const {
   ASSERT(type_ == ActionType::kBasicAttack);
 
   uint32_t idx = 0;
-  for (auto&& act : acts_) {
-    // TODO Keep position info in the object rather than querying stage here
-    Unit* def = stage_->LookupUnit(act->GetUnitDef());
-    if (def->position() == pos) {
+  for (auto&& act : *acts_) {
+    if (act.target_pos == pos) {
       return ActKey{idx};
     }
     idx++;
@@ -151,17 +165,12 @@ ActKey AvailableActs::Find(Vec2D pos) {
   return ActKey{};
 }
 
-ActKey AvailableActs::FindMagic(const string& magic_id, Vec2D pos) {
+ActKey AvailableActs::FindMagic(const string& magic_id, Vec2D pos) const {
   ASSERT(type_ == ActionType::kMagic);
 
   uint32_t idx = 0;
-  for (auto&& act : acts_) {
-    CmdMagic* cm = dynamic_cast<CmdMagic*>(act.get());
-    ASSERT(cm != nullptr);
-    const Magic* magic = cm->magic();
-    // TODO Keep position info in the object rather than querying stage here
-    Unit* def = stage_->LookupUnit(cm->GetUnitDef());
-    if (magic->GetId() == magic_id && def->position() == pos) {
+  for (auto&& act : *acts_) {
+    if (act.magic->GetId() == magic_id && act.target_pos == pos) {
       return ActKey{idx};
     }
     idx++;
@@ -171,15 +180,19 @@ ActKey AvailableActs::FindMagic(const string& magic_id, Vec2D pos) {
 
 // UserInterface
 
-UserInterface::UserInterface(Stage* stage) : stage_(stage) {}
+UserInterface::UserInterface(Stage* stage) : stage_(stage), session_(new QuerySession(stage)) {}
+
+UserInterface::~UserInterface() {}
 
-AvailableUnits UserInterface::QueryUnits() const { return AvailableUnits(stage_); }
+AvailableUnits UserInterface::QueryUnits() const { return session_->GetUnits(); }
 
 const Unit* UserInterface::GetUnit(Vec2D pos) const { return stage_->GetUnitInCell(pos); }
 
 const Unit* UserInterface::GetUnit(const UId& unit_id) const { return stage_->LookupUnit(unit_id); }
 
-const Unit* UserInterface::GetUnit(const UnitKey& unit_key) const { return GetUnit(QueryUnits().Get(unit_key)); }
+const Unit* UserInterface::GetUnit(const UnitKey& unit_key) const {
+  return GetUnit(session_->GetUnits().Get(unit_key));
+}
 
 const Cell* UserInterface::GetCell(Vec2D pos) const { return stage_->GetCell(pos); }
 
@@ -189,10 +202,16 @@ vector<Vec2D> UserInterface::GetPath(const UId& unit_id, Vec2D pos) const {
 }
 
 const IAIUnit* UserInterface::GetAIUnit(const UnitKey& unit_key) const {
-  auto uid = AvailableUnits(stage_).Get(unit_key);
+  auto uid = session_->GetUnits().Get(unit_key);
   return stage_->GetAIUnit(uid);
 }
 
+AIDecisionCache* UserInterface::GetAIDecisionCache() const { return stage_->ai_decision_cache(); }
+
+Rng* UserInterface::GetAIRng() const { return stage_->ai_rng(); }
+
+CombatForecast UserInterface::GetCombatForecast() const { return CombatForecast(stage_); }
+
 Vec2D UserInterface::GetMapSize() const { return stage_->GetMapSize(); }
 
 string UserInterface::GetMapId() const { return stage_->GetMapId(); }
@@ -205,16 +224,24 @@ const Cmd* UserInterface::GetNextCmd() const { return stage_->GetNextCmdConst();
 
 void UserInterface::DoNextCmd() { stage_->DoNext(); }
 
-AvailableMoves UserInterface::QueryMoves(const UnitKey& unit_key) const { return AvailableMoves(stage_, unit_key); }
+bool UserInterface::CanUndo() const { return stage_->CanUndo(); }
+
+bool UserInterface::CanRedo() const { return stage_->CanRedo(); }
+
+bool UserInterface::Undo() { return stage_->Undo(); }
+
+bool UserInterface::Redo() { return stage_->Redo(); }
+
+AvailableMoves UserInterface::QueryMoves(const UnitKey& unit_key) const { return session_->GetMoves(unit_key); }
 
 AvailableActs UserInterface::QueryActs(const UnitKey& unit_key, const MoveKey& move_id, ActionType type) const {
-  return AvailableActs(stage_, unit_key, move_id, type);
+  return session_->GetActs(unit_key, move_id, type);
 }
 
 void UserInterface::PushAction(const UnitKey& unit_key, const MoveKey& move_id, ActionType type, const ActKey& act_id) {
-  UId uid = QueryUnits().Get(unit_key);
-  Vec2D pos = GetMovedPosition(unit_key, move_id);
-  unique_ptr<CmdAct> act = GetActCmd(unit_key, move_id, type, act_id);
+  UId uid = session_->GetUnits().Get(unit_key);
+  Vec2D pos = session_->GetMoves(unit_key).Get(move_id);
+  unique_ptr<CmdAct> act = session_->GetActs(unit_key, move_id, type).Get(act_id);
 
   CmdAction* cmd = new CmdAction(stage_->IsUserTurn() ? CmdAction::Flag::kUserInput : CmdAction::Flag::kDecompose);
   cmd->SetCmdMove(std::make_unique<CmdMove>(uid, pos));
@@ -223,18 +250,21 @@ void UserInterface::PushAction(const UnitKey& unit_key, const MoveKey& move_id,
   stage_->Push(unique_ptr<CmdAction>(cmd));
 }
 
-void UserInterface::PushPlayAI() { stage_->Push(std::make_unique<core::CmdPlayAI>()); }
-
-Vec2D UserInterface::GetMovedPosition(const UnitKey& unit_key, const MoveKey& move_id) {
-  auto moves = QueryMoves(unit_key);
-  return moves.Get(move_id);
+void UserInterface::PushPlayAI() {
+  CmdPlayAI::Mode mode = CmdPlayAI::Mode::kUnit;
+  if (stage_->UsesAIPlanner(stage_->GetCurrentForce())) {
+    mode = (stage_->ai_search_budget() > 0) ? CmdPlayAI::Mode::kSearch : CmdPlayAI::Mode::kPhase;
+  }
+  stage_->Push(std::make_unique<core::CmdPlayAI>(mode));
 }
 
-unique_ptr<CmdAct> UserInterface::GetActCmd(const UnitKey& unit_key, const MoveKey& move_id, ActionType type,
-                                            const ActKey& act_id) {
-  auto acts = QueryActs(unit_key, move_id, type);
-  return acts.Get(act_id);
-}
+void UserInterface::StartAISearch() { stage_->StartAISearch(); }
+
+bool UserInterface::IsAISearchDone() const { return stage_->IsAISearchDone(); }
+
+void UserInterface::PlayAIPhase(vector<VisualEvent>* events) { stage_->PlayAIPhase(events); }
+
+ThreatMap UserInterface::QueryThreatMap(Force force, bool parallel) const { return ThreatMap(stage_, force, parallel); }
 
 void UserInterface::ForEachUnit(const std::function<void(const Unit*)>& fn) const { stage_->ForEachUnit(fn); }
 
@@ -6,12 +6,17 @@
 #include <utility>
 
 #include "cmds.h"
+#include "combat_forecast.h"
 #include "id.h"
+#include "threat_map.h"
 #include "util/common.h"
 
+class Rng;
+
 namespace mengde {
 namespace core {
 
+class AIDecisionCache;
 class Cell;
 class Stage;
 class PathTree;
@@ -20,48 +25,64 @@ class Unit;
 class Turn;
 class MagicList;
 class IAIUnit;
+class QuerySession;
+struct VisualEvent;
+
+// Query results
+//
+// They are immutable snapshots of the stage state at the time of the query, cheap to copy since copies share the
+// data. QuerySession keeps them until the stage changes.
 
 class AvailableUnits {
  public:
   AvailableUnits(Stage* stage);
-  UId Get(const UnitKey& ukey);
-  uint32_t Count() const { return units_.size(); }
-  UnitKey FindByPos(Vec2D pos);
+  UId Get(const UnitKey& ukey) const;
+  uint32_t Count() const { return units_->size(); }
+  UnitKey FindByPos(Vec2D pos) const;
 
  private:
-  vector<std::pair<UId, Vec2D>> units_;
+  shared_ptr<const vector<std::pair<UId, Vec2D>>> units_;
 };
 
 class AvailableMoves {
  public:
-  AvailableMoves(Stage* stage, const UnitKey& ukey);
-  Vec2D Get(const MoveKey& mkey);
-  uint32_t Count() const { return moves_.size(); }
-  void ForEach(const std::function<void(const MoveKey&, Vec2D)>& fn);
-  const vector<Vec2D>& moves() { return moves_; }
+  AvailableMoves(Stage* stage, const UId& uid);
+  Vec2D Get(const MoveKey& mkey) const;
+  uint32_t Count() const { return moves_->size(); }
+  void ForEach(const std::function<void(const MoveKey&, Vec2D)>& fn) const;
+  const vector<Vec2D>& moves() const { return *moves_; }
 
  private:
-  vector<Vec2D> moves_;
+  shared_ptr<const vector<Vec2D>> moves_;
 };
 
 class AvailableActs {
  public:
-  AvailableActs(Stage* stage, const UnitKey& unit_id, const MoveKey& move_id, ActionType type);
-  ActionType type() { return type_; }
-  unique_ptr<CmdAct> Get(const ActKey& akey);
-  uint32_t Count() const { return acts_.size(); }
-  ActKey Find(Vec2D pos);
-  ActKey FindMagic(const string& magic_id, Vec2D pos);
+  AvailableActs(Stage* stage, const UId& uid, Vec2D move_pos, ActionType type);
+  ActionType type() const { return type_; }
+  unique_ptr<CmdAct> Get(const ActKey& akey) const;
+  Vec2D GetTargetPos(const ActKey& akey) const;
+  uint32_t Count() const { return acts_->size(); }
+  ActKey Find(Vec2D pos) const;
+  ActKey FindMagic(const string& magic_id, Vec2D pos) const;
+
+ private:
+  struct Act {
+    UId target;
+    Vec2D target_pos;
+    Magic* magic;  // Only for ActionType::kMagic
+  };
 
  private:
-  Stage* stage_;  // TODO Remove this
+  UId uid_;
   ActionType type_;
-  vector<unique_ptr<CmdAct>> acts_;
+  shared_ptr<const vector<Act>> acts_;
 };
 
 class UserInterface {
  public:
   UserInterface(Stage* stage);
+  ~UserInterface();
 
  public:
   AvailableUnits QueryUnits() const;
@@ -69,6 +90,10 @@ class UserInterface {
   AvailableActs QueryActs(const UnitKey& unit_key, const MoveKey& move_id, ActionType type) const;
   void PushAction(const UnitKey& unit_key, const MoveKey& move_id, ActionType type, const ActKey& act_id);
   void PushPlayAI();
+  void StartAISearch();
+  bool IsAISearchDone() const;
+  void PlayAIPhase(vector<VisualEvent>* events = nullptr);
+  ThreatMap QueryThreatMap(Force force, bool parallel = false) const;
 
   const Unit* GetUnit(const UId& uid) const;
   const Unit* GetUnit(const UnitKey& unit_key) const;
@@ -76,6 +101,9 @@ class UserInterface {
   const Cell* GetCell(Vec2D pos) const;
   vector<Vec2D> GetPath(const UId& unit_id, Vec2D pos) const;
   const IAIUnit* GetAIUnit(const UnitKey& unit_key) const;
+  AIDecisionCache* GetAIDecisionCache() const;
+  Rng* GetAIRng() const;
+  CombatForecast GetCombatForecast() const;
 
   std::shared_ptr<core::MagicList> GetMagicList(const UId& uid) const;
   const Magic* GetMagic(const string& id) const;
@@ -88,6 +116,10 @@ class UserInterface {
   bool HasNextCmd() const;
   const Cmd* GetNextCmd() const;
   void DoNextCmd();
+  bool CanUndo() const;
+  bool CanRedo() const;
+  bool Undo();
+  bool Redo();
 
   void ForEachUnit(const std::function<void(const Unit*)>& fn) const;
 
@@ -97,12 +129,9 @@ class UserInterface {
 
   bool IsValidCoords(Vec2D c) const;
 
- private:
-  Vec2D GetMovedPosition(const UnitKey& unit_id, const MoveKey& move_id);
-  unique_ptr<CmdAct> GetActCmd(const UnitKey& unit_id, const MoveKey& move_id, ActionType type, const ActKey& act_id);
-
  private:
   Stage* stage_;
+  unique_ptr<QuerySession> session_;  // Used by the Query methods and those taking a UnitKey, only on the stage thread
 };
 
 }  // namespace core
@@ -0,0 +1,185 @@
+#include "utility_scorer.h"
+
+#include <limits>
+
+#include "cell.h"
+#include "cmds.h"
+#include "formulae.h"
+#include "magic.h"
+#include "magic_list.h"
+#include "map.h"
+#include "unit.h"
+#include "util/thread_pool.h"
+
+namespace mengde {
+namespace core {
+
+namespace {
+
+const double kTerrainWeight = 0.2;     // Per percent of terrain effect
+const double kApproachWeight = 1.0;    // Per cell to the closest hostile unit
+const double kNonHPMagicValue = 10.0;  // In HP, for stat or condition magics
+const double kThreatWeight = 2.0;      // Per hostile unit that can attack the cell next turn
+
+}  // namespace
+
+const double UtilityScorer::kKillBonus = 30.0;
+const double UtilityScorer::kCounterWeight = 0.5;
+
+double UtilityCandidate::Score(int target_hp, int target_max_hp) const {
+  switch (kind) {
+    case Kind::kStay:
+      return base;
+    case Kind::kHeal:
+      return base + hit * std::min(amount, std::max(target_max_hp - target_hp, 0));
+    case Kind::kOther:
+      return base + hit * kNonHPMagicValue;
+    default:
+      break;
+  }
+
+  ASSERT(kind == Kind::kDamage);
+  if (target_hp <= 0) return base - taken * UtilityScorer::kCounterWeight;  // Nothing left to gain
+
+  // A critical hit does 1.5x as in CmdBasicAttack
+  double kill = 0.0;
+  if (amount >= target_hp) {
+    kill = hit;
+  } else if (amount * 3 / 2 >= target_hp) {
+    kill = hit * critical;
+  }
+  return base + std::min(dealt, static_cast<double>(target_hp)) + kill * UtilityScorer::kKillBonus -
+         (1.0 - kill) * taken * UtilityScorer::kCounterWeight;
+}
+
+unique_ptr<CmdAction> UtilityCandidate::ToCmdAction(const UId& unit) const {
+  auto action = std::make_unique<CmdAction>(CmdAction::Flag::kDecompose);
+  action->SetCmdMove(std::make_unique<CmdMove>(unit, pos));
+  if (type == ActionType::kBasicAttack) {
+    action->SetCmdAct(std::make_unique<CmdBasicAttack>(unit, target, CmdBasicAttack::Type::kActive));
+  } else if (type == ActionType::kMagic) {
+    action->SetCmdAct(std::make_unique<CmdMagic>(unit, target, magic));
+  } else {
+    action->SetCmdAct(std::make_unique<CmdStay>(unit));
+  }
+  return action;
+}
+
+UtilityScorer::UtilityScorer(const UserInterface* ui, Force force) : ui_(ui) {
+  ui->ForEachUnit([&](const Unit* unit) {
+    if (!unit->IsDead() && IsHostile(force, unit->force())) hostiles_.push_back(unit);
+  });
+
+  for (Force hostile : {Force::kOwn, Force::kAlly, Force::kEnemy}) {
+    if (IsHostile(force, hostile)) threats_.push_back(ui->QueryThreatMap(hostile, true));
+  }
+}
+
+vector<UtilityCandidate> UtilityScorer::Evaluate(const Unit* unit, const AvailableMoves& moves) const {
+  vector<Magic*> magics;
+  if (!unit->condition_set().Has(Condition::kStunned)) {
+    auto magic_list = ui_->GetMagicList(unit->uid());
+    for (int i = 0; i < magic_list->NumMagics(); i++) {
+      magics.push_back(magic_list->GetMagic(i));
+    }
+  }
+
+  // Moves are evaluated in parallel and concatenated in move order, so the result does not depend on the scheduling
+  vector<vector<UtilityCandidate>> per_move(moves.Count());
+  ThreadPool::GetInstance()->ParallelFor(moves.Count(), [&](int i) {
+    const uint32_t move = static_cast<uint32_t>(i);
+    EvaluateMove(unit, move, moves.Get(MoveKey{move}), magics, &per_move[i]);
+  });
+
+  vector<UtilityCandidate> candidates;
+  for (auto& e : per_move) {
+    candidates.insert(candidates.end(), e.begin(), e.end());
+  }
+  return candidates;
+}
+
+void UtilityScorer::EvaluateMove(const Unit* atk, uint32_t move, Vec2D pos, const vector<Magic*>& magics,
+                                 vector<UtilityCandidate>* out) const {
+  const Map* map = ui_->GetMap();
+  double base = (map->GetCell(pos)->GetTerrainEffect(atk->class_index()) - 100) * kTerrainWeight;
+  for (const ThreatMap& threat : threats_) {
+    base -= threat.GetNumThreats(pos) * kThreatWeight;
+  }
+
+  int dist = 0;
+  if (!hostiles_.empty()) {
+    dist = std::numeric_limits<int>::max();
+    for (const Unit* hostile : hostiles_) {
+      Vec2D d = hostile->position() - pos;
+      dist = std::min(dist, std::abs(d.x) + std::abs(d.y));
+    }
+  }
+  UtilityCandidate stay{move, pos, UtilityCandidate::Kind::kStay, ActionType::kStay, UId{}, pos, nullptr,
+                        base - dist * kApproachWeight, 0.0, 0.0, 0.0, 0, 0.0};
+  out->push_back(stay);
+
+  if (atk->condition_set().Has(Condition::kStunned)) return;
+
+  // Targets are looked up the same way as AvailableActs does, so a candidate can be found there later
+  atk->attack_range().ForEach(
+      [&](Vec2D target_pos) {
+        if (!ui_->IsValidCoords(target_pos)) return;
+        const Unit* def = ui_->GetUnit(target_pos);
+        if (def == nullptr || !atk->IsHostile(def)) return;
+
+        UtilityCandidate c = stay;
+        c.kind = UtilityCandidate::Kind::kDamage;
+        c.type = ActionType::kBasicAttack;
+        c.target = def->uid();
+        c.target_pos = target_pos;
+        c.base = base;
+        c.hit = Formulae::ComputeBasicAttackAccuracy(atk, def) / 100.0;
+        c.critical = Formulae::ComputeBasicAttackCritical(atk, def) / 100.0;
+        c.amount = Formulae::ComputeBasicAttackDamage(map, atk, pos, def, def->position());
+
+        // Same multipliers as CmdBasicAttack, 1.5x for a critical hit and 0.75x for the second attack
+        const double twice = Formulae::ComputeBasicAttackDouble(atk, def) / 100.0;
+        c.dealt = c.hit * c.amount * (1.0 + 0.5 * c.critical) * (1.0 + 0.75 * twice);
+
+        if (def->IsInRange(pos) && !def->condition_set().Has(Condition::kStunned)) {
+          const double counter_hit = Formulae::ComputeBasicAttackAccuracy(def, atk) / 100.0;
+          const int counter_damage = Formulae::ComputeBasicAttackDamage(map, def, def->position(), atk, pos);
+          c.taken = std::min(counter_hit * counter_damage, static_cast<double>(atk->GetCurrentHpMp().hp));
+        }
+        out->push_back(c);
+      },
+      pos);
+
+  for (Magic* magic : magics) {
+    magic->GetRange().ForEach(
+        [&](Vec2D target_pos) {
+          if (!ui_->IsValidCoords(target_pos)) return;
+          const Unit* def = ui_->GetUnit(target_pos);
+          if (def == nullptr || atk->IsHostile(def) != magic->is_target_enemy()) return;
+
+          UtilityCandidate c = stay;
+          c.type = ActionType::kMagic;
+          c.target = def->uid();
+          c.target_pos = target_pos;
+          c.magic = magic;
+          c.base = base;
+          c.hit = magic->CalcAccuracy(atk, def) / 100.0;
+          const int diff = magic->HasHP() ? magic->HPDiff(atk, def) : 0;
+          if (!magic->HasHP()) {
+            c.kind = UtilityCandidate::Kind::kOther;
+          } else if (diff < 0) {
+            c.kind = UtilityCandidate::Kind::kDamage;
+            c.amount = -diff;
+            c.dealt = c.hit * c.amount;
+          } else {
+            c.kind = UtilityCandidate::Kind::kHeal;
+            c.amount = diff;
+          }
+          out->push_back(c);
+        },
+        pos);
+  }
+}
+
+}  // namespace core
+}  // namespace mengde
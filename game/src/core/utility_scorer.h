@@ -0,0 +1,71 @@
+#ifndef MENGDE_CORE_UTILITY_SCORER_H_
+#define MENGDE_CORE_UTILITY_SCORER_H_
+
+#include "user_interface.h"
+
+namespace mengde {
+namespace core {
+
+class CmdAction;
+class Magic;
+class Unit;
+
+// UtilityCandidate is an action a unit can take, with what its score is made of
+//
+// The score is the expected HP damage dealt(or healed) weighted by the hit chance, plus a bonus for a likely kill,
+// minus the expected counter-attack damage and adjusted by `base`. The parts that depend on the target's HP are kept
+// apart so a planner can rescore a candidate once other units have dealt with the same target.
+
+struct UtilityCandidate {
+  enum class Kind { kStay, kDamage, kHeal, kOther };
+
+  uint32_t move;  // Index of AvailableMoves
+  Vec2D pos;
+  Kind kind;
+  ActionType type;
+  UId target;
+  Vec2D target_pos;
+  Magic* magic;     // Only for ActionType::kMagic
+  double base;      // Terrain and threats of the cell, or how close it is to hostile units for kStay
+  double hit;       // Chance to hit
+  double critical;  // Chance of a critical hit
+  double dealt;     // Expected damage, not capped by the target's HP
+  int amount;       // Damage of a single normal hit, or HP restored by a heal
+  double taken;     // Expected counter-attack damage unless the target is killed
+
+  double Score(int target_hp, int target_max_hp) const;
+  unique_ptr<CmdAction> ToCmdAction(const UId& unit) const;
+};
+
+// UtilityScorer lists and rates the candidates of units of a force
+//
+// Every (move, action, target) combination is a candidate, plus staying at each move which is rated by the distance
+// to the closest hostile unit so units keep closing in. Cells are rated by their terrain effect and by the number of
+// hostile units that can attack them next turn.
+// Hostile units and their threat coverage are gathered once on construction. `Evaluate` spreads the moves over the
+// thread pool and only reads units and the map, so it can also be called from several threads at once while nothing
+// changes the stage.
+
+class UtilityScorer {
+ public:
+  static const double kKillBonus;      // In HP, for the probability of killing the target
+  static const double kCounterWeight;  // Damage taken matters less than damage dealt
+
+ public:
+  UtilityScorer(const UserInterface* ui, Force force);
+  vector<UtilityCandidate> Evaluate(const Unit* unit, const AvailableMoves& moves) const;
+
+ private:
+  void EvaluateMove(const Unit* unit, uint32_t move, Vec2D pos, const vector<Magic*>& magics,
+                    vector<UtilityCandidate>* out) const;
+
+ private:
+  const UserInterface* ui_;
+  vector<const Unit*> hostiles_;
+  vector<ThreatMap> threats_;
+};
+
+}  // namespace core
+}  // namespace mengde
+
+#endif  // MENGDE_CORE_UTILITY_SCORER_H_
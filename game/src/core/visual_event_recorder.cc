@@ -0,0 +1,88 @@
+#include "visual_event_recorder.h"
+
+#include "map.h"
+#include "stage.h"
+
+namespace mengde {
+namespace core {
+
+VisualEventRecorder::VisualEventRecorder(Stage* stage, vector<VisualEvent>* events) : stage_(stage), events_(events) {}
+
+void VisualEventRecorder::Visit(const CmdQueue&) {}
+
+void VisualEventRecorder::Visit(const CmdPlayAI&) {}
+
+void VisualEventRecorder::Visit(const CmdGameVictory&) {}
+
+void VisualEventRecorder::Visit(const CmdAction&) {}
+
+void VisualEventRecorder::Visit(const CmdMove& cmd) {
+  if (stage_->LookupUnit(cmd.GetUnit())->position() == cmd.GetDest()) return;
+
+  VisualEvent event{VisualEvent::Type::kMove, cmd.GetUnit()};
+  event.path = stage_->GetMap()->FindPathTo(cmd.GetUnit(), cmd.GetDest());
+  events_->push_back(std::move(event));
+}
+
+void VisualEventRecorder::Visit(const CmdBasicAttack&) {}
+
+void VisualEventRecorder::Visit(const CmdMagic&) {}
+
+void VisualEventRecorder::Visit(const CmdHit& cmd) {
+  VisualEvent event{cmd.IsBasicAttack() ? VisualEvent::Type::kAttack : VisualEvent::Type::kMagic, cmd.GetUnitAtk()};
+  event.target = cmd.GetUnitDef();
+  event.hit = true;
+  event.critical = (cmd.GetHitType() == CmdHit::HitType::kCritical);
+  event.amount = cmd.GetDamage();
+  event.magic = cmd.GetMagic();
+  events_->push_back(std::move(event));
+}
+
+void VisualEventRecorder::Visit(const CmdMiss& cmd) {
+  VisualEvent event{cmd.IsBasicAttack() ? VisualEvent::Type::kAttack : VisualEvent::Type::kMagic, cmd.GetUnitAtk()};
+  event.target = cmd.GetUnitDef();
+  event.magic = cmd.GetMagic();
+  events_->push_back(std::move(event));
+}
+
+void VisualEventRecorder::Visit(const CmdKilled& cmd) {
+  events_->emplace_back(VisualEvent::Type::kKilled, cmd.GetUnit());
+}
+
+void VisualEventRecorder::Visit(const CmdEndTurn&) { events_->emplace_back(VisualEvent::Type::kEndTurn); }
+
+void VisualEventRecorder::Visit(const CmdStay&) {}
+
+void VisualEventRecorder::Visit(const CmdSpeak& cmd) {
+  VisualEvent event{VisualEvent::Type::kSpeak, cmd.GetUnit()};
+  event.words = cmd.GetWords();
+  events_->push_back(std::move(event));
+}
+
+void VisualEventRecorder::Visit(const CmdGameEnd& cmd) {
+  VisualEvent event{VisualEvent::Type::kGameEnd};
+  event.victory = cmd.is_victory();
+  events_->push_back(std::move(event));
+}
+
+void VisualEventRecorder::Visit(const CmdRestoreHp& cmd) {
+  int amount = cmd.CalcAmount(stage_->user_interface());
+  if (amount == 0) return;
+
+  VisualEvent event{VisualEvent::Type::kRestoreHp, cmd.GetUnit()};
+  event.amount = amount;
+  events_->push_back(std::move(event));
+}
+
+void VisualEventRecorder::Visit(const CmdEndAction&) {}
+
+void VisualEventRecorder::Visit(const CmdGainExp&) {}
+
+void VisualEventRecorder::Visit(const CmdLevelUp&) {}
+
+void VisualEventRecorder::Visit(const CmdPromote& cmd) {
+  events_->emplace_back(VisualEvent::Type::kPromote, cmd.GetUnit());
+}
+
+}  // namespace core
+}  // namespace mengde
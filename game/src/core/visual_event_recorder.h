@@ -0,0 +1,56 @@
+#ifndef MENGDE_CORE_VISUAL_EVENT_RECORDER_H_
+#define MENGDE_CORE_VISUAL_EVENT_RECORDER_H_
+
+#include "cmd_visitor.h"
+
+namespace mengde {
+namespace core {
+
+class Magic;
+class Stage;
+
+// VisualEvent is what a frontend would show for a command, captured right before the command is done
+//
+// It carries everything needed to play the animation later on, when the stage has moved on already.
+
+struct VisualEvent {
+  enum class Type { kMove, kAttack, kMagic, kKilled, kRestoreHp, kSpeak, kEndTurn, kGameEnd, kPromote };
+
+  VisualEvent(Type type, const UId& unit = UId{})
+      : type(type), unit(unit), target(), hit(false), critical(false), victory(false), amount(0), magic(nullptr) {}
+
+  Type type;
+  UId unit;
+  UId target;          // kAttack and kMagic
+  bool hit;            // kAttack and kMagic
+  bool critical;       // kAttack
+  bool victory;        // kGameEnd
+  int amount;          // Damage for kAttack and kMagic, HP restored for kRestoreHp
+  const Magic* magic;  // kMagic
+  vector<Vec2D> path;  // kMove, from the destination to the origin as Map::FindPathTo returns
+  string words;        // kSpeak
+};
+
+// VisualEventRecorder appends the VisualEvent of a command to a list
+//
+// It makes the same decisions as the GUI's StateUIGenerator, so commands that are not animated there are not
+// recorded either. It must visit a command before the command is done, since a move is recorded with the path from
+// where the unit is.
+
+class VisualEventRecorder : public CmdVisitor {
+ public:
+  VisualEventRecorder(Stage* stage, vector<VisualEvent>* events);
+
+ public:
+#define MACRO_CMD_OP(name) virtual void Visit(const Cmd##name& cmd) override final;
+#include "cmd_op.h.inc"
+
+ private:
+  Stage* stage_;
+  vector<VisualEvent>* events_;
+};
+
+}  // namespace core
+}  // namespace mengde
+
+#endif  // MENGDE_CORE_VISUAL_EVENT_RECORDER_H_
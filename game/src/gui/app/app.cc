@@ -1,6 +1,9 @@
 #include "app.h"
 
+#include <chrono>
+
 #include "core/assets.h"
+#include "core/cmd_recorder.h"
 #include "core/exceptions.h"
 #include "core/scenario.h"
 #include "core/stage.h"
@@ -51,6 +54,7 @@ App::App(int width, int height, uint32_t max_frames_sec)
       root_view_(nullptr),
       target_view_(nullptr),
       scenario_(nullptr),
+      recorder_(nullptr),
       frame_config_(max_frames_sec, 2),
       fps_timer_(),
       quit_(false) {
@@ -78,6 +82,7 @@ App::~App() {
   if (root_view_ != nullptr) {
     delete root_view_;
   }
+  StopRecording();
   delete main_view_;
   delete drawer_;
   delete window_;
@@ -98,6 +103,7 @@ void App::SetupScenario(const string& scenario_id) {
     UNREACHABLE("Scenario config load failure.");
   }
 
+  SeedStage();
   root_view_ = new RootView(Rect({0, 0}, window_size_), scenario_, this);
   drawer_->SetBitmapBasePath(GetCurrentScenarioPath().ToString());
 }
@@ -181,9 +187,11 @@ void App::StartNewScenario(const string& scenario_id) {
 
 void App::EndStage() {
   delete root_view_;
+  StopRecording();
   bool has_next = scenario_->NextStage();
 
   if (has_next) {
+    SeedStage();
     root_view_ = new RootView(Rect({0, 0}, window_size_), scenario_, this);
     target_view_ = root_view_;
   } else {
@@ -204,6 +212,32 @@ void App::EndStage() {
   */
 }
 
+void App::SeedStage() {
+  // Every game is a different one, and the seed is kept by the stage and its log to play it again
+  const uint64_t seed = std::chrono::system_clock::now().time_since_epoch().count();
+  scenario_->current_stage()->Seed(seed);
+  LOG_INFO("Stage seed : %llu", static_cast<unsigned long long>(seed));
+}
+
+void App::StartRecording() {
+  // Only the first stage of a scenario can be played again, as the others begin with what the ones before left
+  if (scenario_->stage_no() != 0) return;
+  core::Stage* stage = scenario_->current_stage();
+  recorder_ = std::make_unique<core::CmdRecorder>(stage, scenario_->id());
+  stage->SetCmdRecorder(recorder_.get());
+}
+
+void App::StopRecording() {
+  if (recorder_ == nullptr) return;
+  scenario_->current_stage()->SetCmdRecorder(nullptr);
+  const string file_name = scenario_->id() + "_" + std::to_string(recorder_->log().seed()) + ".mdcl";
+  const Path path = GameEnv::GetInstance()->GetGamePath() / file_name;
+  if (!recorder_->log().Save(path.ToString())) {
+    LOG_WARNING("Failed to write the log of the stage to '%s'", path.ToString().c_str());
+  }
+  recorder_.reset();
+}
+
 void App::NextFrame(NextFrameCallback cb) { frame_callbacks_.push(cb); }
 
 void App::RunCallbacks() {
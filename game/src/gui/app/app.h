@@ -13,6 +13,7 @@
 namespace mengde {
 namespace core {
 
+class CmdRecorder;
 class Stage;
 class Scenario;
 
@@ -71,6 +72,7 @@ class App {
   void SetMagicListViewVisible(bool);
   void SetQuit(bool b) { quit_ = b; }
   void EndStage();
+  void StartRecording();
 
   void StartNewScenario(const string& scenario_id);
   void SetupScenario(const string& scenario_id);
@@ -83,6 +85,8 @@ class App {
   void Render();
 
   void RunCallbacks();
+  void SeedStage();
+  void StopRecording();
 
  private:
   EventFetcher event_fetcher_;
@@ -93,6 +97,7 @@ class App {
   RootView* root_view_;
   View* target_view_;
   core::Scenario* scenario_;
+  unique_ptr<core::CmdRecorder> recorder_;  // Of the stage being played, if it is recorded
 
   queue<NextFrameCallback> frame_callbacks_;
 
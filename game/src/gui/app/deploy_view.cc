@@ -157,6 +157,7 @@ DeployView::DeployView(const Rect& frame, core::Assets* assets, core::IDeployHel
     if (e.IsLeftButtonUp()) {
       if (deploy_helper->SubmitDeploy()) {
         this->visible(false);
+        gv_->StartRecording();
         gv_->InitUIStateMachine();
       }
     }
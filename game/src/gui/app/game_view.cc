@@ -167,6 +167,8 @@ void GameView::EndStage() {
   app_->NextFrame([=]() { app_->EndStage(); });
 }
 
+void GameView::StartRecording() { app_->StartRecording(); }
+
 // private methods
 
 void GameView::NextFrame(NextFrameCallback cb) { frame_callbacks_.push(cb); }
@@ -92,6 +92,7 @@ class GameView : public View {
  public:
   Vec2D GetMouseCoords() { return mouse_coords_; }
   void EndStage();
+  void StartRecording();
   void NextFrame(NextFrameCallback);
   void SetUIViews(UIViews* ui_views) { ui_views_ = ui_views; }
   void RaiseMouseOverEvent();
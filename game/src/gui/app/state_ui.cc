@@ -183,6 +183,24 @@ bool StateUIOperable::IsScrollUp() { return scroll_up_; }
 
 bool StateUIOperable::IsScrollDown() { return scroll_down_; }
 
+// StateUIThinking
+
+StateUIThinking::StateUIThinking(StateUI::Base base) : StateUIOperable(base) {}
+
+void StateUIThinking::Enter() {
+  StateUIOperable::Enter();
+  gi_->StartAISearch();
+}
+
+void StateUIThinking::Update() {
+  StateUIOperable::Update();
+
+  // The next CmdPlayAI takes over the result when this state is popped back to StateUIDoCmd
+  if (gi_->IsAISearchDone()) {
+    gv_->PopUIState();
+  }
+}
+
 // StateUIView
 
 StateUIView::StateUIView(Base base) : StateUIOperable(base), units_(gi_->QueryUnits()) {}
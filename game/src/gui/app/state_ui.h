@@ -130,6 +130,20 @@ class StateUIOperable : public StateUI {
   bool scroll_down_;
 };
 
+// StateUIThinking
+//
+// Waits for AISearch running on a worker thread, while the camera can still be moved around.
+
+class StateUIThinking : public StateUIOperable {
+ public:
+  StateUIThinking(StateUI::Base);
+  virtual void Enter() override;
+  virtual void Update() override;
+#ifdef DEBUG
+  virtual string GetStateID() const override { return "StateUIThinking"; }
+#endif
+};
+
 class StateUIView : public StateUIOperable {
  public:
   StateUIView(StateUI::Base);
@@ -8,7 +8,13 @@ using namespace mengde::core;
 
 void StateUIGenerator::Visit(const CmdQueue&) { generated_ = nullptr; }
 
-void StateUIGenerator::Visit(const CmdPlayAI&) { generated_ = nullptr; }
+void StateUIGenerator::Visit(const CmdPlayAI& cmd) {
+  if (cmd.mode() == CmdPlayAI::Mode::kSearch) {
+    generated_ = new StateUIThinking(WrapBase());
+  } else {
+    generated_ = nullptr;
+  }
+}
 
 void StateUIGenerator::Visit(const CmdGameVictory&) { generated_ = nullptr; }
 
@@ -0,0 +1,74 @@
+// Headless replay
+//
+// Plays the stages recorded by `simulate` or by the game again from their logs, with no AI run and nothing shown, and
+// reports how each one ended and how fast it was done. As the logs have the seed of the stage, the result is the one
+// of the game that was recorded. Units alive and their HP are reported for the own, ally and enemy forces in that
+// order.
+//
+// Like the game, it is run from the install folder.
+//
+// Usage: replay <log>...
+
+#include <chrono>
+
+#include "core/cmd_log.h"
+#include "core/cmd_replayer.h"
+#include "core/force.h"
+#include "core/scenario.h"
+#include "core/stage.h"
+#include "core/unit.h"
+#include "util/common.h"
+
+using namespace mengde::core;
+
+namespace {
+
+const char* const kStatusNames[] = {"none", "deploying", "undecided", "victory", "defeat"};
+
+bool Replay(const char* path) {
+  CmdLog log;
+  if (!log.Load(path)) {
+    printf("%s: not a valid log\n", path);
+    return false;
+  }
+
+  Scenario scenario(log.scenario_id());
+  Stage* stage = scenario.current_stage();
+  CmdReplayer replayer(stage, &log);
+  auto time_begin = std::chrono::steady_clock::now();
+  const bool ok = replayer.Replay();
+  auto time_end = std::chrono::steady_clock::now();
+  if (!ok) {
+    printf("%s: does not fit '%s', stopped after %u Cmds\n", path, log.scenario_id().c_str(), replayer.num_done());
+    return false;
+  }
+
+  int hp[kNumForces] = {};
+  int alive[kNumForces] = {};
+  stage->ForEachUnitConst([&](const Unit* unit) {
+    if (unit->IsDead()) return;
+    hp[ForceToIndex(unit->force())] += unit->GetCurrentHpMp().hp;
+    alive[ForceToIndex(unit->force())]++;
+  });
+  const double us = std::chrono::duration_cast<std::chrono::microseconds>(time_end - time_begin).count();
+  printf("%s: %s at turn %d, alive %d/%d/%d, hp %d/%d/%d, %u Cmds in %.1f ms (%.0f Cmds/s)\n", path,
+         kStatusNames[static_cast<int>(stage->GetStatus())], stage->GetTurn().current(), alive[0], alive[1], alive[2],
+         hp[0], hp[1], hp[2], replayer.num_done(), us / 1e3, replayer.num_done() / (us / 1e6));
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    printf("Usage: %s <log>...\n", argv[0]);
+    return 1;
+  }
+  Logger::GetInstance()->SetLevel(Logger::kLogFatal);
+
+  int failed = 0;
+  for (int i = 1; i < argc; i++) {
+    if (!Replay(argv[i])) failed++;
+  }
+  return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,196 @@
+// Headless batch simulation
+//
+// Plays the current stage of a scenario over and over with AI controlling every force, and reports the win rate, the
+// turn count and the damage dealt by each force. Game `i` is seeded with `seed + i`, so every game can be replayed on
+// its own regardless of how many threads played the batch. Games are spread over the threads of ThreadPool and do
+// not share anything but the read-only game data on disk.
+//
+// Like the game, it is run from the install folder.
+//
+// Usage: simulate [games] [seed] [scenario] [own_ai_mode] [planner] [log_prefix]
+//
+//   own_ai_mode  AI mode of the own units, "utility" by default
+//   planner      1 to plan the phases of every force with AIPlanner, 0 by default
+//   log_prefix   If given, game `i` is recorded to "<log_prefix><seed + i>.mdcl", which `replay` plays again
+
+#include <chrono>
+#include <mutex>
+
+#include "core/ai_decision_cache.h"
+#include "core/ai_mode.h"
+#include "core/assets.h"
+#include "core/cmd_recorder.h"
+#include "core/force.h"
+#include "core/scenario.h"
+#include "core/stage.h"
+#include "core/turn.h"
+#include "core/unit.h"
+#include "core/user_interface.h"
+#include "core/visual_event_recorder.h"
+#include "util/common.h"
+#include "util/thread_pool.h"
+
+using namespace mengde::core;
+
+namespace {
+
+const uint16_t kMaxTurns = 100;  // Guards against stages that would never end, like ones where nobody can reach
+
+const Force kForces[kNumForces] = {Force::kOwn, Force::kAlly, Force::kEnemy};
+const char* const kForceNames[kNumForces] = {"own", "ally", "enemy"};
+
+struct GameResult {
+  Stage::Status status;
+  uint16_t turns;
+  int damage[kNumForces];  // Dealt by each force
+  int losses[kNumForces];  // Units of each force dead at the end
+  uint32_t cache_hits;     // Of AIDecisionCache
+  uint32_t cache_misses;
+};
+
+struct Options {
+  string scenario;
+  AIMode own_ai_mode;
+  bool planner;
+  string log_prefix;
+};
+
+void Deploy(Stage* stage) {
+  for (const Hero* hero : stage->assets()->GetHeroes()) {
+    if (stage->SubmitDeploy()) return;
+    if (stage->FindDeploy(hero) == 0) stage->AssignDeploy(hero);
+  }
+  if (!stage->SubmitDeploy()) throw "Not enough heroes to deploy";
+}
+
+GameResult PlayGame(const Options& options, uint64_t seed) {
+  Scenario scenario(options.scenario);
+  Stage* stage = scenario.current_stage();
+  UserInterface* ui = stage->user_interface();
+  stage->Seed(seed);
+  Deploy(stage);
+
+  unique_ptr<CmdRecorder> recorder;
+  if (!options.log_prefix.empty()) {
+    recorder = std::make_unique<CmdRecorder>(stage, scenario.id());
+    stage->SetCmdRecorder(recorder.get());
+  }
+
+  stage->SetUserControlled(false);
+  stage->ForEachUnit([&](Unit* unit) {
+    if (unit->force() == Force::kOwn) stage->SetAIMode(unit->uid(), options.own_ai_mode);
+  });
+  for (Force force : kForces) {
+    stage->SetAIPlanner(force, options.planner);
+  }
+
+  GameResult result{};
+  const uint16_t max_turns = std::min(stage->GetTurn().limit(), kMaxTurns);
+  vector<VisualEvent> events;
+  while (stage->GetStatus() == Stage::Status::kUndecided && stage->GetTurn().current() <= max_turns) {
+    events.clear();
+    ui->PlayAIPhase(&events);
+    for (const VisualEvent& e : events) {
+      if (e.type == VisualEvent::Type::kAttack || e.type == VisualEvent::Type::kMagic) {
+        const int force = ForceToIndex(stage->LookupUnit(e.unit)->force());
+        const bool damaging = e.type == VisualEvent::Type::kAttack || e.amount < 0;
+        if (e.hit && damaging) result.damage[force] += std::abs(e.amount);
+      }
+    }
+  }
+  // Counted at the end rather than from kKilled events, since the game may be decided before a killed unit's
+  // CmdKilled is done
+  stage->ForEachUnitConst([&](const Unit* unit) {
+    if (unit->IsDead()) result.losses[ForceToIndex(unit->force())]++;
+  });
+  result.cache_hits = stage->ai_decision_cache()->num_hits();
+  result.cache_misses = stage->ai_decision_cache()->num_misses();
+  result.status = stage->GetStatus();
+  result.turns = std::min(stage->GetTurn().current(), max_turns);
+  if (recorder != nullptr) {
+    stage->SetCmdRecorder(nullptr);
+    if (!recorder->log().Save(options.log_prefix + std::to_string(seed) + ".mdcl")) throw "Failed to write a log";
+  }
+  return result;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  int num_games = (argc > 1) ? atoi(argv[1]) : 100;
+  uint64_t seed = (argc > 2) ? strtoull(argv[2], nullptr, 10) : 0;
+  Options options;
+  options.scenario = (argc > 3) ? argv[3] : "example";
+  options.own_ai_mode = StringToAIMode((argc > 4) ? argv[4] : "utility");
+  options.planner = (argc > 5) ? atoi(argv[5]) != 0 : false;
+  options.log_prefix = (argc > 6) ? argv[6] : "";
+  Logger::GetInstance()->SetLevel(Logger::kLogFatal);
+
+  if (options.own_ai_mode == AIMode::kNone) {
+    printf("Unknown AI mode '%s'\n", argv[4]);
+    return 1;
+  }
+
+  ThreadPool* pool = ThreadPool::GetInstance();
+  printf("%d games of '%s', seed %llu, %d threads\n", num_games, options.scenario.c_str(),
+         static_cast<unsigned long long>(seed), pool->num_threads());
+
+  vector<GameResult> results(num_games);
+  string error;
+  std::mutex error_mutex;
+  auto time_begin = std::chrono::steady_clock::now();
+  pool->ParallelFor(num_games, [&](int i) {
+    try {
+      results[i] = PlayGame(options, seed + i);
+    } catch (const char* msg) {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      error = msg;
+    }
+  });
+  auto time_end = std::chrono::steady_clock::now();
+
+  if (!error.empty()) {
+    LOG_FATAL("Caught Exception : %s", error.c_str());
+    return 1;
+  }
+  if (num_games <= 0) return 0;
+
+  int victories = 0;
+  int defeats = 0;
+  int total_turns = 0;
+  int min_turns = results[0].turns;
+  int max_turns = results[0].turns;
+  int64_t damage[kNumForces] = {};
+  int64_t losses[kNumForces] = {};
+  int64_t cache_hits = 0;
+  int64_t cache_misses = 0;
+  for (const GameResult& r : results) {
+    if (r.status == Stage::Status::kVictory) victories++;
+    if (r.status == Stage::Status::kDefeat) defeats++;
+    total_turns += r.turns;
+    min_turns = std::min<int>(min_turns, r.turns);
+    max_turns = std::max<int>(max_turns, r.turns);
+    for (int f = 0; f < kNumForces; f++) {
+      damage[f] += r.damage[f];
+      losses[f] += r.losses[f];
+    }
+    cache_hits += r.cache_hits;
+    cache_misses += r.cache_misses;
+  }
+
+  const double n = num_games;
+  const double secs = std::chrono::duration_cast<std::chrono::microseconds>(time_end - time_begin).count() / 1e6;
+  printf("victory %5.1f%%  defeat %5.1f%%  undecided %5.1f%%\n", 100.0 * victories / n, 100.0 * defeats / n,
+         100.0 * (num_games - victories - defeats) / n);
+  printf("turns   avg %5.2f  min %d  max %d\n", total_turns / n, min_turns, max_turns);
+  for (int f = 0; f < kNumForces; f++) {
+    printf("%-6s  damage %8.1f  losses %5.2f  (per game)\n", kForceNames[f], damage[f] / n, losses[f] / n);
+  }
+  if (cache_hits + cache_misses > 0) {
+    printf("ai decision cache  hits %lld  misses %lld  (%.1f%% hits)\n", static_cast<long long>(cache_hits),
+           static_cast<long long>(cache_misses), 100.0 * cache_hits / (cache_hits + cache_misses));
+  }
+  printf("%.2f s, %.1f games/s\n", secs, n / secs);
+
+  return 0;
+}
@@ -1,12 +1,5 @@
 #include "misc_helpers.h"
 #include <sstream>
-#include "stdlib.h"
-
-// return an integer between [0, end)
-int GenRandom(int v) { return rand() % v; }
-
-// return an integer between [begin, end)
-int GenRandom(int begin, int end) { return begin + GenRandom(end - begin); }
 
 vector<string> SplitString(const string& str, char sep) {
   std::stringstream ss(str);
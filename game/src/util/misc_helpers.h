@@ -9,9 +9,6 @@ using std::vector;
 
 // Miscellaneous Helpers
 
-int GenRandom(int);
-int GenRandom(int, int);
-
 vector<string> SplitString(const string&, char);
 
 #endif  // UTIL_MISC_HELPERS_H_
@@ -0,0 +1,37 @@
+#include "rng.h"
+
+Rng::Rng(uint64_t seed) { Seed(seed); }
+
+// The state is filled with SplitMix64 outputs, so similar seeds still give unrelated sequences and the state is never
+// all zero
+void Rng::Seed(uint64_t seed) {
+  for (int i = 0; i < 4; i += 2) {
+    uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z = z ^ (z >> 31);
+    s_[i] = static_cast<uint32_t>(z);
+    s_[i + 1] = static_cast<uint32_t>(z >> 32);
+  }
+}
+
+Rng Rng::Split() {
+  Rng stream = *this;
+  Jump();
+  return stream;
+}
+
+// Same as 2^64 calls to `Next`, with the jump polynomial of xoshiro128**
+void Rng::Jump() {
+  static const uint32_t kJump[] = {0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b};
+  uint32_t s[4] = {0, 0, 0, 0};
+  for (uint32_t jump : kJump) {
+    for (int b = 0; b < 32; b++) {
+      if (jump & (1u << b)) {
+        for (int i = 0; i < 4; i++) s[i] ^= s_[i];
+      }
+      Next();
+    }
+  }
+  for (int i = 0; i < 4; i++) s_[i] = s[i];
+}
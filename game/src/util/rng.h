@@ -0,0 +1,41 @@
+#ifndef UTIL_RNG_H_
+#define UTIL_RNG_H_
+
+#include <stdint.h>
+
+// Rng is a small seedable pseudo random number generator(xoshiro128**)
+//
+// It has no global state, so the same seed always produces the same sequence regardless of what else is going on, and
+// each stage, thread or simulation owns its own generator. Copying an Rng forks the sequence, while `Split` makes an
+// independent stream for another thread without seeding one from scratch.
+
+class Rng {
+ public:
+  Rng(uint64_t seed = 0);
+  void Seed(uint64_t seed);
+  uint32_t Next() {
+    const uint32_t result = Rotl(s_[1] * 5, 7) * 9;
+    const uint32_t t = s_[1] << 9;
+    s_[2] ^= s_[0];
+    s_[3] ^= s_[1];
+    s_[1] ^= s_[2];
+    s_[0] ^= s_[3];
+    s_[2] ^= t;
+    s_[3] = Rotl(s_[3], 11);
+    return result;
+  }
+  // A number in [0, v)
+  int Gen(int v) { return static_cast<int>((static_cast<uint64_t>(Next()) * static_cast<uint32_t>(v)) >> 32); }
+  // Returns a generator that goes on with this sequence, and jumps this one 2^64 numbers ahead. Streams split this way
+  // never overlap unless one of them draws 2^64 numbers.
+  Rng Split();
+
+ private:
+  static uint32_t Rotl(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+  void Jump();
+
+ private:
+  uint32_t s_[4];
+};
+
+#endif  // UTIL_RNG_H_
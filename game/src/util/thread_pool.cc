@@ -0,0 +1,98 @@
+#include "thread_pool.h"
+
+namespace {
+
+thread_local bool in_job = false;
+
+}  // namespace
+
+ThreadPool* ThreadPool::GetInstance() {
+  static ThreadPool instance(std::max(1u, std::thread::hardware_concurrency()) - 1);
+  return &instance;
+}
+
+ThreadPool::ThreadPool(int num_workers)
+    : job_(nullptr), job_size_(0), next_index_(0), num_busy_workers_(0), generation_(0), stopping_(false) {
+  ASSERT_GE(num_workers, 0);
+  for (int i = 0; i < num_workers; i++) {
+    workers_.emplace_back(&ThreadPool::WorkerMain, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cv_work_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::ParallelFor(int n, const function<void(int)>& fn) {
+  if (n <= 0) return;
+  if (workers_.empty() || n == 1 || in_job) {
+    for (int i = 0; i < n; i++) fn(i);
+    return;
+  }
+
+  std::lock_guard<std::mutex> job_lock(job_mutex_);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    job_ = &fn;
+    job_size_ = n;
+    next_index_ = 0;
+    num_busy_workers_ = workers_.size();
+    generation_++;
+  }
+  cv_work_.notify_all();
+
+  RunJob();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_done_.wait(lock, [this] { return num_busy_workers_ == 0; });
+  job_ = nullptr;
+  if (error_) {
+    std::exception_ptr error = error_;
+    error_ = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+void ThreadPool::WorkerMain() {
+  uint32_t done_generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_work_.wait(lock, [&] { return stopping_ || generation_ != done_generation; });
+      if (stopping_) return;
+      done_generation = generation_;
+    }
+
+    RunJob();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--num_busy_workers_ == 0) cv_done_.notify_one();
+  }
+}
+
+void ThreadPool::RunJob() {
+  in_job = true;
+  while (true) {
+    int index;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (next_index_ >= job_size_) break;
+      index = next_index_++;
+    }
+    try {
+      (*job_)(index);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!error_) error_ = std::current_exception();
+      next_index_ = job_size_;
+    }
+  }
+  in_job = false;
+}
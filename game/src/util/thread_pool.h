@@ -0,0 +1,47 @@
+#ifndef UTIL_THREAD_POOL_H_
+#define UTIL_THREAD_POOL_H_
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "common.h"
+
+// ThreadPool runs data parallel jobs on a fixed set of worker threads
+//
+// `ParallelFor(n, fn)` calls `fn(0)` ... `fn(n - 1)` spread over the workers and the calling thread, and returns
+// when all of them are done. One job runs at a time. A `ParallelFor` called from inside a job runs serially on the
+// calling thread rather than waiting for workers that are busy with the outer job. If a call of `fn` throws, no more
+// indices are handed out and the first exception is rethrown by `ParallelFor` on the calling thread.
+
+class ThreadPool {
+ public:
+  static ThreadPool* GetInstance();
+
+ public:
+  ThreadPool(int num_workers);
+  ~ThreadPool();
+  int num_threads() const { return workers_.size() + 1; }
+  void ParallelFor(int n, const function<void(int)>& fn);
+
+ private:
+  void WorkerMain();
+  void RunJob();
+
+ private:
+  vector<std::thread> workers_;
+  std::mutex job_mutex_;  // Serializes jobs
+  std::mutex mutex_;      // Guards the members below
+  std::condition_variable cv_work_;
+  std::condition_variable cv_done_;
+  const function<void(int)>* job_;
+  int job_size_;
+  int next_index_;
+  int num_busy_workers_;
+  std::exception_ptr error_;  // First exception thrown by the current job
+  uint32_t generation_;
+  bool stopping_;
+};
+
+#endif  // UTIL_THREAD_POOL_H_
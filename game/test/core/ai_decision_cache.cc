@@ -0,0 +1,64 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Main
+#include <boost/test/unit_test.hpp>
+
+#include "core/ai_decision_cache.h"
+#include "core/unit.h"
+#include "test_stage.h"
+
+using namespace ::mengde::core;
+
+BOOST_AUTO_TEST_CASE(TranslationInvariant) {
+  TestStage stage("twins.lua");
+  AIDecisionCache cache(stage.get());
+  const Unit* left = stage->LookupUnit(UId{0});
+  const Unit* right = stage->LookupUnit(UId{2});
+
+  // The same surroundings within the radius, and different ones once the radius reaches the edge of the map
+  BOOST_CHECK_EQUAL(cache.Key(left, AIMode::kUtility, 2), cache.Key(right, AIMode::kUtility, 2));
+  BOOST_CHECK_NE(cache.Key(left, AIMode::kUtility, 3), cache.Key(right, AIMode::kUtility, 3));
+
+  // The unit next to it is hostile to one and friendly to the other
+  BOOST_CHECK_NE(cache.Key(left, AIMode::kUtility, 2), cache.Key(stage->LookupUnit(UId{1}), AIMode::kUtility, 2));
+  BOOST_CHECK_NE(cache.Key(left, AIMode::kUtility, 2), cache.Key(left, AIMode::kUnitInRangeRandom, 2));
+}
+
+BOOST_AUTO_TEST_CASE(Counters) {
+  TestStage stage("twins.lua");
+  AIDecisionCache cache(stage.get());
+  const uint64_t key = cache.Key(stage->LookupUnit(UId{0}), AIMode::kUtility, 2);
+  const AIDecisionCache::Decision decision{{1, 0}, ActionType::kBasicAttack, {1, 0}};
+  AIDecisionCache::Decision found{};
+
+  BOOST_CHECK(!cache.Find(key, &found));
+  BOOST_CHECK_EQUAL(cache.num_hits(), 0u);
+  BOOST_CHECK_EQUAL(cache.num_misses(), 1u);
+
+  cache.Insert(key, decision);
+  BOOST_CHECK(cache.Find(key, &found));
+  BOOST_CHECK(found.move == decision.move && found.type == decision.type && found.target == decision.target);
+  BOOST_CHECK_EQUAL(cache.num_hits(), 1u);
+  BOOST_CHECK_EQUAL(cache.num_misses(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(RemoveStaleHit) {
+  TestStage stage("twins.lua");
+  AIDecisionCache cache(stage.get());
+  const uint64_t key = cache.Key(stage->LookupUnit(UId{0}), AIMode::kUtility, 2);
+  AIDecisionCache::Decision found{};
+
+  cache.Insert(key, {{1, 0}, ActionType::kBasicAttack, {1, 0}});
+  BOOST_CHECK(cache.Find(key, &found));
+
+  // The hit did not fit, so it counts as a miss and the decision is gone
+  cache.Remove(key);
+  BOOST_CHECK_EQUAL(cache.num_hits(), 0u);
+  BOOST_CHECK_EQUAL(cache.num_misses(), 1u);
+  BOOST_CHECK(!cache.Find(key, &found));
+  BOOST_CHECK_EQUAL(cache.num_misses(), 2u);
+
+  // Removing what is not there changes nothing
+  cache.Remove(key);
+  BOOST_CHECK_EQUAL(cache.num_hits(), 0u);
+  BOOST_CHECK_EQUAL(cache.num_misses(), 2u);
+}
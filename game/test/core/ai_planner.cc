@@ -0,0 +1,92 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Main
+#include <boost/test/unit_test.hpp>
+
+#include "core/ai_phase_plan.h"
+#include "core/cmds.h"
+#include "core/unit.h"
+#include "core/user_interface.h"
+#include "test_stage.h"
+
+using namespace ::mengde::core;
+
+namespace {
+
+const int kNumTurns = 3;
+
+void SetUpPlanner(Stage* stage) {
+  stage->SetUserControlled(false);
+  for (Force force : {Force::kOwn, Force::kAlly, Force::kEnemy}) {
+    stage->SetAIPlanner(force, true);
+  }
+}
+
+// Plays the phases of every force with AIPlanner and checks each action right before it is done
+void CheckPlayedActions(const string& script) {
+  TestStage stage(script);
+  SetUpPlanner(stage.get());
+
+  int num_actions = 0;
+  while (stage->GetStatus() == Stage::Status::kUndecided && stage->GetTurn().current() <= kNumTurns) {
+    if (!stage->HasNext()) stage->user_interface()->PushPlayAI();
+    const Cmd* cmd = stage->GetNextCmdConst();
+    if (cmd->op() == Cmd::Op::kCmdAction) {
+      const CmdMove* move = static_cast<const CmdAction*>(cmd)->cmd_move();
+      BOOST_REQUIRE(move != nullptr);
+      Unit* unit = stage->LookupUnit(move->GetUnit());
+      BOOST_REQUIRE(!unit->IsDead() && !unit->IsDoneAction());
+      BOOST_REQUIRE(unit->force() == stage->GetCurrentForce());
+      const Vec2D dest = move->GetDest();
+      if (dest != unit->position()) {
+        BOOST_REQUIRE(stage->GetUnitInCell(dest) == nullptr);
+        const vector<Vec2D> cells = stage->FindMovablePos(unit);
+        BOOST_REQUIRE(std::find(cells.begin(), cells.end(), dest) != cells.end());
+      }
+      num_actions++;
+    }
+    stage->DoNext();
+  }
+  BOOST_CHECK(num_actions > 0);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(LegalMoves) { CheckPlayedActions("skirmish.lua"); }
+
+BOOST_AUTO_TEST_CASE(LegalMovesAfterReinforcement) { CheckPlayedActions("reinforcement.lua"); }
+
+BOOST_AUTO_TEST_CASE(PlanKeptForPhase) {
+  TestStage stage("skirmish.lua");
+  SetUpPlanner(stage.get());
+
+  // Units are far apart in the first phase, so nothing but the plan's own actions changes the stage
+  const AIPhasePlan* plan = nullptr;
+  int num_actions = 0;
+  while (stage->GetCurrentForce() == Force::kOwn) {
+    if (!stage->HasNext()) stage->user_interface()->PushPlayAI();
+    const bool play_ai = stage->GetNextCmdConst()->op() == Cmd::Op::kCmdPlayAI;
+    stage->DoNext();
+    if (play_ai && stage->GetNextCmdConst()->op() == Cmd::Op::kCmdAction) {
+      if (plan == nullptr) plan = stage->ai_phase_plan();
+      BOOST_CHECK_EQUAL(stage->ai_phase_plan(), plan);
+      num_actions++;
+    }
+  }
+  BOOST_CHECK_EQUAL(num_actions, 3);
+}
+
+BOOST_AUTO_TEST_CASE(PlannedAgainAfterReinforcement) {
+  TestStage stage("reinforcement.lua");
+  SetUpPlanner(stage.get());
+
+  // Reinforcements are generated at the end of the second action, which the rest of the plan could not foresee
+  vector<const AIPhasePlan*> plans;
+  while (plans.size() < 3) {
+    if (!stage->HasNext()) stage->user_interface()->PushPlayAI();
+    const bool play_ai = stage->GetNextCmdConst()->op() == Cmd::Op::kCmdPlayAI;
+    stage->DoNext();
+    if (play_ai) plans.push_back(stage->ai_phase_plan());
+  }
+  BOOST_CHECK_EQUAL(plans[0], plans[1]);
+  BOOST_CHECK_NE(plans[1], plans[2]);
+}
@@ -0,0 +1,109 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Main
+#include <boost/test/unit_test.hpp>
+
+#include <set>
+
+#include "core/ai_search.h"
+#include "core/cmds.h"
+#include "core/unit.h"
+#include "core/user_interface.h"
+#include "test_stage.h"
+
+using namespace ::mengde::core;
+
+namespace {
+
+const uint32_t kIterations = 200;
+const int kNumTurns = 3;
+const int kNumSeeds = 10;
+
+// Checks an action right before it is done, like AIPlanner's
+void CheckAction(Stage* stage, const Cmd* cmd) {
+  BOOST_REQUIRE(cmd->op() == Cmd::Op::kCmdAction);
+  const CmdAction* action = static_cast<const CmdAction*>(cmd);
+  const CmdMove* move = action->cmd_move();
+  BOOST_REQUIRE(move != nullptr && action->cmd_act() != nullptr);
+  Unit* unit = stage->LookupUnit(move->GetUnit());
+  BOOST_REQUIRE(!unit->IsDead() && !unit->IsDoneAction());
+  BOOST_REQUIRE(unit->force() == stage->GetCurrentForce());
+  BOOST_CHECK(action->cmd_act()->GetUnitAtk() == unit->uid());
+  if (action->cmd_act()->GetUnitDef()) BOOST_REQUIRE(!stage->LookupUnit(action->cmd_act()->GetUnitDef())->IsDead());
+  if (move->GetDest() != unit->position()) {
+    BOOST_REQUIRE(stage->GetUnitInCell(move->GetDest()) == nullptr);
+    const vector<Vec2D> cells = stage->FindMovablePos(unit);
+    BOOST_REQUIRE(std::find(cells.begin(), cells.end(), move->GetDest()) != cells.end());
+  }
+}
+
+// A full plan has an action for every unit that has not acted yet, each checked and done in turn, and is then over
+void CheckFullPlan(Stage* stage, unique_ptr<AIPhasePlan> plan) {
+  BOOST_REQUIRE(plan != nullptr);
+  AvailableUnits units = stage->user_interface()->QueryUnits();
+  std::set<uint32_t> planned;
+  while (unique_ptr<Cmd> cmd = plan->Next(stage)) {
+    CheckAction(stage, cmd.get());
+    const UId uid = static_cast<const CmdAction*>(cmd.get())->cmd_move()->GetUnit();
+    BOOST_CHECK(planned.insert(uid.Value()).second);
+    stage->Push(std::move(cmd));
+    while (stage->HasNext()) stage->DoNext();
+  }
+  BOOST_CHECK_EQUAL(planned.size(), units.Count());
+  BOOST_CHECK_EQUAL(stage->user_interface()->QueryUnits().Count(), 0u);
+}
+
+// Plays the phases of every force with AISearch through CmdPlayAI and checks each action right before it is done
+void CheckPlayedActions(const string& script, uint64_t seed) {
+  TestStage stage(script, seed);
+  stage->SetUserControlled(false);
+  stage->SetAISearchBudget(3);
+  for (Force force : {Force::kOwn, Force::kAlly, Force::kEnemy}) {
+    stage->SetAIPlanner(force, true);
+  }
+
+  int num_actions = 0;
+  while (stage->GetStatus() == Stage::Status::kUndecided && stage->GetTurn().current() <= kNumTurns) {
+    if (!stage->HasNext()) stage->user_interface()->PushPlayAI();
+    const Cmd* cmd = stage->GetNextCmdConst();
+    if (cmd->op() == Cmd::Op::kCmdAction) {
+      CheckAction(stage.get(), cmd);
+      num_actions++;
+    }
+    stage->DoNext();
+  }
+  BOOST_CHECK(num_actions > 0);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(SearchResult) {
+  TestStage stage("skirmish.lua");
+  AISearch search(stage.get());
+  search.Search(60 * 1000, kIterations);
+  BOOST_CHECK_EQUAL(search.iterations(), kIterations);
+  CheckFullPlan(stage.get(), search.Result());
+}
+
+BOOST_AUTO_TEST_CASE(ResultWithoutSearch) {
+  TestStage stage("skirmish.lua");
+  AISearch search(stage.get());
+  CheckFullPlan(stage.get(), search.Result());
+}
+
+BOOST_AUTO_TEST_CASE(TaskResult) {
+  TestStage stage("skirmish.lua");
+  AISearchTask task(stage.get(), 10);
+  CheckFullPlan(stage.get(), task.Finish());
+}
+
+BOOST_AUTO_TEST_CASE(LegalMoves) {
+  for (uint64_t seed = 0; seed < kNumSeeds; seed++) {
+    CheckPlayedActions("skirmish.lua", seed);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(LegalMovesAfterReinforcement) {
+  for (uint64_t seed = 0; seed < kNumSeeds; seed++) {
+    CheckPlayedActions("reinforcement.lua", seed);
+  }
+}
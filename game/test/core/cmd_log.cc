@@ -0,0 +1,145 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Main
+#include <boost/test/unit_test.hpp>
+
+#include "core/cmd_log.h"
+#include "core/cmds.h"
+#include "core/magic.h"
+#include "test_stage.h"
+
+using namespace ::mengde::core;
+
+namespace {
+
+const UId kAtk{0};
+const UId kDef{1};
+
+// Offsets in an encoded CmdAction with a move and a basic attack, of units and coords that take a byte each
+const size_t kFlag = 1;
+const size_t kMoveUnit = 3;
+const size_t kMoveX = 4;
+const size_t kMoveY = 5;
+const size_t kActOp = 6;
+const size_t kAttackType = 9;
+
+unique_ptr<Cmd> MakeAttack(Vec2D dest, CmdBasicAttack::Type type) {
+  auto action = std::make_unique<CmdAction>(CmdAction::Flag::kUserInput);
+  action->SetCmdMove(std::make_unique<CmdMove>(kAtk, dest));
+  action->SetCmdAct(std::make_unique<CmdBasicAttack>(kAtk, kDef, type));
+  return std::move(action);
+}
+
+unique_ptr<Cmd> MakeMagic(Stage* stage, const string& magic_id) {
+  auto action = std::make_unique<CmdAction>();
+  action->SetCmdAct(std::make_unique<CmdMagic>(kAtk, kDef, stage->LookupMagic(magic_id)));
+  return std::move(action);
+}
+
+string Encode(const Cmd& cmd) {
+  string data;
+  BOOST_REQUIRE(CmdLog::EncodeCmd(cmd, &data));
+  return data;
+}
+
+string Patch(string data, size_t offset, uint8_t value) {
+  BOOST_REQUIRE(offset < data.size());
+  data[offset] = static_cast<char>(value);
+  return data;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(RoundTrip) {
+  TestStage stage("duel.lua");
+  CmdLog log(1234567890123ull, "example");
+  log.AddDeploy(0, "CaoCao");
+  log.AddDeploy(3, "XunYu");
+  log.set_num_done(300);
+  BOOST_REQUIRE(log.Append(CmdLog::Kind::kInput, 0, MakeAttack({3, 2}, CmdBasicAttack::Type::kActive).get()));
+  BOOST_REQUIRE(log.Append(CmdLog::Kind::kAIPush, 5, MakeMagic(stage.get(), "fire_0").get()));
+  BOOST_REQUIRE(log.Append(CmdLog::Kind::kAIResult, 5, std::make_unique<CmdEndTurn>().get()));
+  BOOST_REQUIRE(log.Append(CmdLog::Kind::kUndo, 200, nullptr));
+  BOOST_REQUIRE(log.Append(CmdLog::Kind::kRedo, 200, nullptr));
+  BOOST_REQUIRE(log.Append(CmdLog::Kind::kInput, 299, std::make_unique<CmdPlayAI>(CmdPlayAI::Mode::kSearch).get()));
+  BOOST_CHECK(!log.Append(CmdLog::Kind::kInput, 299, std::make_unique<CmdStay>(kAtk).get()));
+
+  CmdLog loaded;
+  BOOST_REQUIRE(loaded.Deserialize(log.Serialize()));
+  BOOST_CHECK_EQUAL(loaded.seed(), log.seed());
+  BOOST_CHECK_EQUAL(loaded.scenario_id(), log.scenario_id());
+  BOOST_CHECK_EQUAL(loaded.num_done(), log.num_done());
+  BOOST_REQUIRE_EQUAL(loaded.deploys().size(), log.deploys().size());
+  for (size_t i = 0; i < log.deploys().size(); i++) {
+    BOOST_CHECK_EQUAL(loaded.deploys()[i].no, log.deploys()[i].no);
+    BOOST_CHECK_EQUAL(loaded.deploys()[i].hero_id, log.deploys()[i].hero_id);
+  }
+  BOOST_REQUIRE_EQUAL(loaded.entries().size(), log.entries().size());
+  for (size_t i = 0; i < log.entries().size(); i++) {
+    const CmdLog::Entry& entry = loaded.entries()[i];
+    BOOST_CHECK(entry.kind == log.entries()[i].kind);
+    BOOST_CHECK_EQUAL(entry.count, log.entries()[i].count);
+    BOOST_CHECK_EQUAL(entry.cmd, log.entries()[i].cmd);
+    // Decoded Cmds are encoded the same again
+    if (!entry.cmd.empty()) {
+      unique_ptr<Cmd> cmd = CmdLog::DecodeCmd(entry.cmd, stage.get());
+      BOOST_REQUIRE(cmd != nullptr);
+      BOOST_CHECK_EQUAL(Encode(*cmd), entry.cmd);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(CorruptLog) {
+  CmdLog log(7, "example");
+  log.AddDeploy(0, "CaoCao");
+  BOOST_REQUIRE(log.Append(CmdLog::Kind::kInput, 0, std::make_unique<CmdEndTurn>().get()));
+  const string data = log.Serialize();
+
+  CmdLog loaded;
+  BOOST_CHECK(!loaded.Deserialize(""));
+  BOOST_CHECK(!loaded.Deserialize(Patch(data, 0, 'X')));                   // Magic
+  BOOST_CHECK(!loaded.Deserialize(Patch(data, 4, CmdLog::kVersion + 1)));  // Version
+  BOOST_CHECK(!loaded.Deserialize(data.substr(0, data.size() - 1)));
+  BOOST_CHECK(!loaded.Deserialize(data + '\x7f'));  // Kind
+  BOOST_CHECK(loaded.Deserialize(data));
+}
+
+BOOST_AUTO_TEST_CASE(CorruptCmd) {
+  TestStage stage("duel.lua");
+  Stage* s = stage.get();
+  const string attack = Encode(*MakeAttack({3, 2}, CmdBasicAttack::Type::kActive));
+  BOOST_REQUIRE(CmdLog::DecodeCmd(attack, s) != nullptr);
+  const string counter = Patch(attack, kAttackType, CmdBasicAttack::kCounter | CmdBasicAttack::kSecond);
+  BOOST_REQUIRE(CmdLog::DecodeCmd(counter, s) != nullptr);
+
+  BOOST_CHECK(CmdLog::DecodeCmd("", s) == nullptr);
+  BOOST_CHECK(CmdLog::DecodeCmd(attack.substr(0, attack.size() - 1), s) == nullptr);
+  BOOST_CHECK(CmdLog::DecodeCmd(attack + '\0', s) == nullptr);
+  BOOST_CHECK(CmdLog::DecodeCmd(Patch(attack, 0, 0xff), s) == nullptr);
+
+  // Flags
+  BOOST_CHECK(CmdLog::DecodeCmd(Patch(attack, kFlag, 0), s) == nullptr);
+  BOOST_CHECK(CmdLog::DecodeCmd(Patch(attack, kFlag, 3), s) == nullptr);
+
+  // Units and cells that do not exist, the map being 6x4
+  BOOST_CHECK(CmdLog::DecodeCmd(Patch(attack, kMoveUnit, 0), s) == nullptr);
+  BOOST_CHECK(CmdLog::DecodeCmd(Patch(attack, kMoveUnit, 3), s) == nullptr);
+  BOOST_CHECK(CmdLog::DecodeCmd(Patch(attack, kMoveX, 6), s) == nullptr);
+  BOOST_CHECK(CmdLog::DecodeCmd(Patch(attack, kMoveY, 4), s) == nullptr);
+  BOOST_CHECK(CmdLog::DecodeCmd(Patch(attack, kActOp, 0xff), s) == nullptr);
+
+  // Types of basic attack
+  BOOST_CHECK(CmdLog::DecodeCmd(Patch(attack, kAttackType, CmdBasicAttack::kNone), s) == nullptr);
+  BOOST_CHECK(CmdLog::DecodeCmd(Patch(attack, kAttackType, CmdBasicAttack::kSecond), s) == nullptr);
+  BOOST_CHECK(CmdLog::DecodeCmd(Patch(attack, kAttackType, CmdBasicAttack::kActiveOrCounter), s) == nullptr);
+  BOOST_CHECK(CmdLog::DecodeCmd(Patch(attack, kAttackType, 0x11), s) == nullptr);
+
+  // Magics, named by id
+  const string magic = Encode(*MakeMagic(s, "fire_0"));
+  BOOST_REQUIRE(CmdLog::DecodeCmd(magic, s) != nullptr);
+  BOOST_CHECK(CmdLog::DecodeCmd(Patch(magic, magic.size() - 1, 'X'), s) == nullptr);
+
+  // Modes of CmdPlayAI
+  const string play_ai = Encode(CmdPlayAI(CmdPlayAI::Mode::kReplay));
+  BOOST_REQUIRE(CmdLog::DecodeCmd(play_ai, s) != nullptr);
+  BOOST_CHECK(CmdLog::DecodeCmd(Patch(play_ai, 1, static_cast<uint8_t>(CmdPlayAI::Mode::kReplay) + 1), s) == nullptr);
+}
@@ -0,0 +1,93 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Main
+#include <boost/test/unit_test.hpp>
+
+#include "core/assets.h"
+#include "core/combat_forecast.h"
+#include "core/formulae.h"
+#include "core/hero.h"
+#include "core/unit.h"
+#include "test_stage.h"
+
+using namespace ::mengde::core;
+
+namespace {
+
+const UId kHero{0};  // Deployed before the enemy is generated
+const UId kEnemy{1};
+
+double SumChances(const CombatForecast::Result& result) {
+  double sum = 0.0;
+  for (int i = 0; i < result.num_outcomes; i++) sum += result.outcomes[i].chance;
+  return sum;
+}
+
+void EquipHeavenSword(Stage* stage) {
+  stage->assets()->LookupHero("CaoCao")->PutOn(stage->LookupEquipment("heaven_sword"));
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(ChancesSumToOne) {
+  for (uint64_t seed = 0; seed < 4; seed++) {
+    TestStage stage("skirmish.lua", seed);
+    CombatForecast forecast(stage.get());
+    stage->ForEachUnit([&](Unit* atk) {
+      stage->ForEachUnit([&](Unit* def) {
+        if (atk == def) return;
+        const CombatForecast::Result result = forecast.ForecastBasicAttack(atk, atk->position(), def);
+        BOOST_CHECK_CLOSE(SumChances(result), 1.0, 1e-9);
+        BOOST_CHECK(result.kill_rate >= 0.0 && result.kill_rate <= 1.0 + 1e-9);
+        BOOST_CHECK(result.death_rate >= 0.0 && result.death_rate <= 1.0 + 1e-9);
+      });
+    });
+  }
+}
+
+BOOST_AUTO_TEST_CASE(CertainHit) {
+  TestStage stage("hero.lua");
+  const Unit* hero = stage->LookupUnit(kHero);
+  const Unit* enemy = stage->LookupUnit(kEnemy);
+
+  // The hero's first strike always hits critically and kills, so there is no second attack nor a counter-attack
+  BOOST_REQUIRE_EQUAL(Formulae::ComputeBasicAttackAccuracy(hero, enemy), 100);
+  BOOST_REQUIRE_EQUAL(Formulae::ComputeBasicAttackCritical(hero, enemy), 100);
+  const CombatForecast::Result result = CombatForecast(stage.get()).ForecastBasicAttack(hero, hero->position(), enemy);
+  const int enemy_hp = enemy->GetCurrentHpMp().hp;
+  BOOST_REQUIRE_EQUAL(result.num_outcomes, 1);
+  BOOST_CHECK_EQUAL(result.outcomes[0].dealt, enemy_hp);
+  BOOST_CHECK_EQUAL(result.outcomes[0].taken, 0);
+  BOOST_CHECK_EQUAL(result.outcomes[0].chance, 1.0);
+  BOOST_CHECK_EQUAL(result.kill_rate, 1.0);
+  BOOST_CHECK_EQUAL(result.death_rate, 0.0);
+  BOOST_CHECK_EQUAL(result.counter_rate, 0.0);
+  BOOST_CHECK_EQUAL(result.damage_dealt, enemy_hp);
+}
+
+BOOST_AUTO_TEST_CASE(PreemptiveAttack) {
+  // Without the sword, the enemy strikes first and may hit before the hero's counter-attack kills it
+  {
+    TestStage stage("hero.lua");
+    const Unit* enemy = stage->LookupUnit(kEnemy);
+    const CombatForecast::Result result =
+        CombatForecast(stage.get()).ForecastBasicAttack(enemy, enemy->position(), stage->LookupUnit(kHero));
+    BOOST_CHECK_CLOSE(SumChances(result), 1.0, 1e-9);
+    BOOST_CHECK(result.num_outcomes > 1);
+    BOOST_CHECK(result.damage_dealt > 0.0);
+    BOOST_CHECK(result.counter_rate > 0.0);
+  }
+
+  // With it, the hero attacked strikes first instead and the enemy never gets to
+  {
+    TestStage stage("hero.lua", 0, EquipHeavenSword);
+    const Unit* enemy = stage->LookupUnit(kEnemy);
+    const CombatForecast::Result result =
+        CombatForecast(stage.get()).ForecastBasicAttack(enemy, enemy->position(), stage->LookupUnit(kHero));
+    BOOST_REQUIRE_EQUAL(result.num_outcomes, 1);
+    BOOST_CHECK_EQUAL(result.outcomes[0].dealt, 0);
+    BOOST_CHECK_EQUAL(result.outcomes[0].taken, enemy->GetCurrentHpMp().hp);
+    BOOST_CHECK_EQUAL(result.outcomes[0].chance, 1.0);
+    BOOST_CHECK_EQUAL(result.death_rate, 1.0);
+    BOOST_CHECK_EQUAL(result.kill_rate, 0.0);
+  }
+}
@@ -0,0 +1,37 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Main
+#include <boost/test/unit_test.hpp>
+
+#include "core/cmds.h"
+#include "core/combat_sim.h"
+#include "core/unit.h"
+#include "test_stage.h"
+
+using namespace ::mengde::core;
+
+namespace {
+
+int GetHP(Stage* stage, const UId& uid) { return std::max(stage->LookupUnit(uid)->GetCurrentHpMp().hp, 0); }
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(BasicAttackSameAsCmd) {
+  const UId atk{0};
+  const UId def{1};
+  for (uint64_t seed = 0; seed < 100; seed++) {
+    TestStage stage("duel.lua", seed);
+
+    // The simulation draws from a copy of the stage's Rng, so it gets the rolls the Cmd gets
+    CombatSim sim(stage.get());
+    Rng rng = *stage->rng();
+    sim.DoBasicAttack(atk, def, &rng);
+
+    auto action = std::make_unique<CmdAction>();
+    action->SetCmdAct(std::make_unique<CmdBasicAttack>(atk, def, CmdBasicAttack::Type::kActive));
+    stage->Push(std::move(action));
+    while (stage->HasNext()) stage->DoNext();
+
+    BOOST_CHECK_EQUAL(std::max(sim.GetHP(atk), 0), GetHP(stage.get(), atk));
+    BOOST_CHECK_EQUAL(std::max(sim.GetHP(def), 0), GetHP(stage.get(), def));
+  }
+}
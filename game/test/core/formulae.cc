@@ -0,0 +1,75 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Main
+#include <boost/test/unit_test.hpp>
+
+#include "core/formulae.h"
+
+using namespace ::mengde::core;
+
+namespace {
+
+// Every pair of values in [0, max_atk] x [1, max_def]
+void MakePairs(int max_atk, int max_def, vector<int>* atk, vector<int>* def) {
+  for (int a = 0; a <= max_atk; a++) {
+    for (int d = 1; d <= max_def; d++) {
+      atk->push_back(a);
+      def->push_back(d);
+    }
+  }
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(DamageBatch_MatchesScalar) {
+  vector<int> atk, def;
+  MakePairs(400, 400, &atk, &def);
+  const int n = atk.size();
+  vector<int> atk_effect(n), def_effect(n), level(n), out(n);
+  for (int i = 0; i < n; i++) {
+    atk_effect[i] = 80 + i % 7 * 10;
+    def_effect[i] = 80 + i % 5 * 10;
+    level[i] = 1 + i % 50;
+  }
+
+  for (int ratio : {100, 50, 150, -30}) {
+    Formulae::ComputeDamageBatch(n, atk.data(), atk_effect.data(), def.data(), def_effect.data(), level.data(), ratio,
+                                 out.data());
+    for (int i = 0; i < n; i++) {
+      int expected = Formulae::ComputeDamageBase(atk[i] * atk_effect[i] / 100, def[i] * def_effect[i] / 100, level[i],
+                                                 ratio);
+      BOOST_REQUIRE_EQUAL(out[i], expected);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(AccuracyBatch_MatchesScalar) {
+  vector<int> atk, def;
+  MakePairs(600, 600, &atk, &def);
+  const int n = atk.size();
+  vector<int> out(n);
+
+  for (int cap : {100, 50}) {
+    Formulae::ComputeAccuracyBatch(n, atk.data(), def.data(), cap, out.data());
+    for (int i = 0; i < n; i++) {
+      BOOST_REQUIRE_EQUAL(out[i], Formulae::ComputeAccuracyBase(atk[i], def[i], cap));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(DoubleCriticalBatch_MatchesScalar) {
+  vector<int> atk, def;
+  MakePairs(600, 600, &atk, &def);
+  const int n = atk.size();
+  vector<int> out(n);
+
+  Formulae::ComputeDoubleCriticalBatch(n, atk.data(), def.data(), out.data());
+  for (int i = 0; i < n; i++) {
+    BOOST_REQUIRE_EQUAL(out[i], Formulae::ComputeDoubleCriticalBase(atk[i], def[i]));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Batch_Empty) {
+  Formulae::ComputeAccuracyBatch(0, nullptr, nullptr, 100, nullptr);
+  Formulae::ComputeDoubleCriticalBatch(0, nullptr, nullptr, nullptr);
+  Formulae::ComputeDamageBatch(0, nullptr, nullptr, nullptr, nullptr, nullptr, 100, nullptr);
+}
@@ -0,0 +1,41 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Main
+#include <boost/test/unit_test.hpp>
+
+#include "core/path_tree.h"
+
+using namespace ::mengde::core;
+
+BOOST_AUTO_TEST_CASE(AdoptAndFind) {
+  PathTree tree(SearchArea::Diamond({10, 10}, {5, 5}, 2), {5, 5});
+  PathNode* right = tree.Adopt({6, 5}, tree.GetRoot());
+  tree.Adopt({6, 4}, right);
+
+  BOOST_CHECK(tree.GetRoot()->IsRoot());
+  BOOST_CHECK(tree.IsNodeExist({6, 4}));
+  BOOST_CHECK(!tree.IsNodeExist({4, 5}));
+  BOOST_CHECK(!tree.IsNodeExist({0, 0}));  // Out of the area
+  BOOST_CHECK(tree.FindNode({6, 5}) == right);
+  BOOST_CHECK(tree.FindNode({6, 4})->GetParent() == right);
+}
+
+BOOST_AUTO_TEST_CASE(NodeListKeepsAdoptionOrder) {
+  PathTree tree(SearchArea::Whole({4, 4}), {1, 1});
+  tree.Adopt({1, 2}, tree.GetRoot());
+  tree.Adopt({0, 1}, tree.GetRoot());
+  tree.Adopt({0, 0}, tree.FindNode({0, 1}));
+
+  vector<Vec2D> expected = {{1, 1}, {1, 2}, {0, 1}, {0, 0}};
+  BOOST_CHECK(tree.GetNodeList() == expected);
+}
+
+BOOST_AUTO_TEST_CASE(PathToRoot) {
+  PathTree tree(SearchArea::Whole({4, 4}), {0, 0});
+  tree.Adopt({1, 0}, tree.GetRoot());
+  tree.Adopt({2, 0}, tree.FindNode({1, 0}));
+  tree.Adopt({2, 1}, tree.FindNode({2, 0}));
+
+  vector<Vec2D> expected = {{2, 1}, {2, 0}, {1, 0}, {0, 0}};
+  BOOST_CHECK(tree.GetPathToRoot({2, 1}) == expected);
+  BOOST_CHECK(tree.GetPathToRoot({3, 3}).empty());
+}
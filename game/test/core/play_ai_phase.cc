@@ -0,0 +1,122 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Main
+#include <boost/test/unit_test.hpp>
+
+#include "core/cmds.h"
+#include "core/unit.h"
+#include "core/user_interface.h"
+#include "core/visual_event_recorder.h"
+#include "test_stage.h"
+
+using namespace ::mengde::core;
+
+namespace {
+
+const int kNumPhases = 9;
+
+// Plays a phase Cmd by Cmd like the GUI does, and returns the events of the Cmds that StateUIGenerator animates
+vector<VisualEvent> PlayAnimated(Stage* stage) {
+  vector<VisualEvent> events;
+  while (stage->GetStatus() == Stage::Status::kUndecided) {
+    if (!stage->HasNext()) stage->user_interface()->PushPlayAI();
+    const Cmd* cmd = stage->GetNextCmdConst();
+    switch (cmd->op()) {
+      case Cmd::Op::kCmdMove: {
+        const CmdMove* move = static_cast<const CmdMove*>(cmd);
+        const Vec2D origin = stage->LookupUnit(move->GetUnit())->position();
+        if (origin == move->GetDest()) break;
+        VisualEvent event{VisualEvent::Type::kMove, move->GetUnit()};
+        event.path = {move->GetDest(), origin};
+        events.push_back(event);
+        break;
+      }
+      case Cmd::Op::kCmdHit:
+      case Cmd::Op::kCmdMiss: {
+        const CmdActResult* result = static_cast<const CmdActResult*>(cmd);
+        VisualEvent event{result->IsBasicAttack() ? VisualEvent::Type::kAttack : VisualEvent::Type::kMagic,
+                          result->GetUnitAtk()};
+        event.target = result->GetUnitDef();
+        if (cmd->op() == Cmd::Op::kCmdHit) {
+          const CmdHit* hit = static_cast<const CmdHit*>(cmd);
+          event.hit = true;
+          event.critical = (hit->GetHitType() == CmdHit::HitType::kCritical);
+          event.amount = hit->GetDamage();
+        }
+        events.push_back(event);
+        break;
+      }
+      case Cmd::Op::kCmdKilled:
+        events.emplace_back(VisualEvent::Type::kKilled, static_cast<const CmdKilled*>(cmd)->GetUnit());
+        break;
+      case Cmd::Op::kCmdEndTurn:
+        events.emplace_back(VisualEvent::Type::kEndTurn);
+        break;
+      case Cmd::Op::kCmdSpeak:
+        events.emplace_back(VisualEvent::Type::kSpeak, static_cast<const CmdSpeak*>(cmd)->GetUnit());
+        break;
+      case Cmd::Op::kCmdGameEnd:
+        events.emplace_back(VisualEvent::Type::kGameEnd);
+        break;
+      case Cmd::Op::kCmdRestoreHp: {
+        const CmdRestoreHp* restore = static_cast<const CmdRestoreHp*>(cmd);
+        VisualEvent event{VisualEvent::Type::kRestoreHp, restore->GetUnit()};
+        event.amount = restore->CalcAmount(stage->user_interface());
+        if (event.amount != 0) events.push_back(event);
+        break;
+      }
+      case Cmd::Op::kCmdPromote:
+        events.emplace_back(VisualEvent::Type::kPromote, static_cast<const CmdPromote*>(cmd)->GetUnit());
+        break;
+      default:
+        break;
+    }
+    const bool end_turn = (cmd->op() == Cmd::Op::kCmdEndTurn);
+    stage->DoNext();
+    if (end_turn) break;
+  }
+  return events;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(SameAsAnimated) {
+  TestStage recorded("skirmish.lua", 7);
+  TestStage animated("skirmish.lua", 7);
+  recorded->SetUserControlled(false);
+  animated->SetUserControlled(false);
+
+  for (int phase = 0; phase < kNumPhases && recorded->GetStatus() == Stage::Status::kUndecided; phase++) {
+    const Force force = recorded->GetCurrentForce();
+    vector<VisualEvent> events;
+    recorded->PlayAIPhase(&events);
+    const vector<VisualEvent> expected = PlayAnimated(animated.get());
+
+    BOOST_REQUIRE_EQUAL(events.size(), expected.size());
+    for (uint32_t i = 0; i < events.size(); i++) {
+      const VisualEvent& e = events[i];
+      const VisualEvent& x = expected[i];
+      BOOST_CHECK(e.type == x.type);
+      BOOST_CHECK(e.unit == x.unit);
+      BOOST_CHECK(e.target == x.target);
+      BOOST_CHECK_EQUAL(e.hit, x.hit);
+      BOOST_CHECK_EQUAL(e.critical, x.critical);
+      BOOST_CHECK_EQUAL(e.amount, x.amount);
+      if (e.type == VisualEvent::Type::kMove) {
+        BOOST_REQUIRE(!e.path.empty());
+        BOOST_CHECK(e.path.front() == x.path.front());
+        BOOST_CHECK(e.path.back() == x.path.back());
+      }
+    }
+
+    // It stops right after CmdEndTurn, which is the last event when the stage is not decided in the middle
+    if (recorded->GetStatus() == Stage::Status::kUndecided) {
+      BOOST_REQUIRE(!events.empty());
+      BOOST_CHECK(events.back().type == VisualEvent::Type::kEndTurn);
+      BOOST_CHECK(std::count_if(events.begin(), events.end(),
+                                [](const VisualEvent& e) { return e.type == VisualEvent::Type::kEndTurn; }) == 1);
+      BOOST_CHECK(recorded->GetCurrentForce() != force);
+    }
+    BOOST_CHECK(recorded->GetCurrentForce() == animated->GetCurrentForce());
+    BOOST_CHECK(recorded->HasNext() == animated->HasNext());
+  }
+}
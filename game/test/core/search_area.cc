@@ -0,0 +1,48 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Main
+#include <boost/test/unit_test.hpp>
+
+#include "core/search_area.h"
+
+using namespace ::mengde::core;
+
+BOOST_AUTO_TEST_CASE(Whole_RowMajor) {
+  SearchArea area = SearchArea::Whole({5, 4});
+  BOOST_CHECK(area.size() == 20);
+  BOOST_CHECK(area.ToIndex({3, 2}) == 13);
+  BOOST_CHECK(area.ToCoords(13) == Vec2D(3, 2));
+  BOOST_CHECK(!area.Contains({5, 0}));
+}
+
+BOOST_AUTO_TEST_CASE(Diamond_Size) {
+  BOOST_CHECK(SearchArea::Diamond({100, 100}, {50, 50}, 0).size() == 1);
+  BOOST_CHECK(SearchArea::Diamond({100, 100}, {50, 50}, 1).size() == 5);
+  BOOST_CHECK(SearchArea::Diamond({100, 100}, {50, 50}, 6).size() == 85);
+}
+
+BOOST_AUTO_TEST_CASE(Diamond_IndicesAreDenseAndRowMajor) {
+  const int kRadius = 5;
+  const Vec2D kPivot{10, 10};
+  SearchArea area = SearchArea::Diamond({30, 30}, kPivot, kRadius);
+
+  int expected = 0;
+  for (int y = kPivot.y - kRadius; y <= kPivot.y + kRadius; y++) {
+    for (int x = kPivot.x - kRadius; x <= kPivot.x + kRadius; x++) {
+      Vec2D c{x, y};
+      if (!area.Contains(c)) continue;
+      BOOST_CHECK(area.ToIndex(c) == expected);
+      BOOST_CHECK(area.ToCoords(expected) == c);
+      expected++;
+    }
+  }
+  BOOST_CHECK(expected == area.size());
+}
+
+BOOST_AUTO_TEST_CASE(Diamond_ClippedByMap) {
+  SearchArea area = SearchArea::Diamond({4, 4}, {0, 0}, 3);
+  BOOST_CHECK(area.Contains({0, 0}));
+  BOOST_CHECK(area.Contains({3, 0}));
+  BOOST_CHECK(!area.Contains({-1, 0}));
+  BOOST_CHECK(!area.Contains({2, 2}));
+  BOOST_CHECK(area.ToCoords(area.ToIndex({1, 2})) == Vec2D(1, 2));
+}
@@ -0,0 +1,59 @@
+-- Two units next to each other, for tests of combat
+
+gstage = {
+    title_id = "Duel",
+    turn_limit = 20,
+    map = {
+        size = {6, 4},
+        terrain = {
+            "ffffff",
+            "ffmfff",
+            "ffffff",
+            "ffffff"
+        },
+        file = "map"
+    },
+    deploy = {
+        unselectables = {},
+        num_required_selectables = 0,
+        selectables = {}
+    }
+}
+
+
+function on_deploy(game)
+end
+
+
+function on_begin(game)
+    game:generate_unit("DianWei", 10, Enum.force.own, {2, 1})
+    game:generate_unit("LuBu", 10, Enum.force.enemy, {3, 1})
+end
+
+
+function on_victory(game)
+end
+
+
+function on_defeat(game)
+end
+
+
+function end_condition(game)
+    if game:get_num_owns_alive() == 0 then
+        return Enum.status.defeat
+    end
+    if game:get_num_enemies_alive() == 0 then
+        return Enum.status.victory
+    end
+    return Enum.status.undecided
+end
+
+
+function main(game)
+    game:set_on_deploy(on_deploy)
+    game:set_on_begin(on_begin)
+    game:set_on_victory(on_victory)
+    game:set_on_defeat(on_defeat)
+    game:set_end_condition(end_condition)
+end
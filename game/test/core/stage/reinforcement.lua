@@ -0,0 +1,109 @@
+-- The skirmish stage where reinforcements fill the middle of the map after the second action, while a phase is
+-- being played
+
+gstage = {
+    title_id = "Reinforcement",
+    turn_limit = 20,
+    map = {
+        size = {12, 10},
+        terrain = {
+            "ffffmmffffff",
+            "ffffmmffffff",
+            "ffWWffffrrff",
+            "ffffffffrrff",
+            "fffffmmfffff",
+            "fffffmmfffff",
+            "ffrrffffWWff",
+            "ffrrffffffff",
+            "ffffffmmffff",
+            "ffffffmmffff"
+        },
+        file = "map"
+    },
+    deploy = {
+        unselectables = {},
+        num_required_selectables = 0,
+        selectables = {}
+    }
+}
+
+
+function on_deploy(game)
+end
+
+
+function on_begin(game)
+    local own = {
+        game:generate_unit("CaoCao", 10, Enum.force.own, {1, 1}),
+        game:generate_unit("XiahouDun", 8, Enum.force.own, {2, 1}),
+        game:generate_unit("XunYu", 8, Enum.force.own, {1, 2})
+    }
+    local allies = {
+        game:generate_unit("DianWei", 9, Enum.force.ally, {1, 8})
+    }
+    local enemies = {
+        game:generate_unit("LuBu", 9, Enum.force.enemy, {10, 8}),
+        game:generate_unit("Bandit", 7, Enum.force.enemy, {9, 8}),
+        game:generate_unit("Cavalry", 7, Enum.force.enemy, {10, 7}),
+        game:generate_unit("Bandit", 6, Enum.force.enemy, {6, 3})
+    }
+    for _, unit in ipairs(own) do
+        game:set_ai_mode(unit, "utility")
+    end
+    for _, unit in ipairs(allies) do
+        game:set_ai_mode(unit, "utility")
+    end
+    for _, unit in ipairs(enemies) do
+        game:set_ai_mode(unit, "unit_in_range_random")
+    end
+end
+
+
+function on_victory(game)
+end
+
+
+function on_defeat(game)
+end
+
+
+function end_condition(game)
+    if game:get_num_owns_alive() == 0 then
+        return Enum.status.defeat
+    end
+    if game:get_num_enemies_alive() == 0 then
+        return Enum.status.victory
+    end
+    return Enum.status.undecided
+end
+
+
+num_checks = 0
+
+
+function reinforcement_condition(game)
+    num_checks = num_checks + 1
+    return num_checks == 2
+end
+
+
+function reinforcement_handler(game, event_id)
+    for x = 4, 7 do
+        for y = 0, 9 do
+            if game:get_unit_on_position({x, y}) == nil then
+                game:generate_unit("Bandit", 5, Enum.force.ally, {x, y})
+            end
+        end
+    end
+    game:unregister_event(event_id)
+end
+
+
+function main(game)
+    game:set_on_deploy(on_deploy)
+    game:set_on_begin(on_begin)
+    game:set_on_victory(on_victory)
+    game:set_on_defeat(on_defeat)
+    game:set_end_condition(end_condition)
+    game:register_event(reinforcement_condition, reinforcement_handler)
+end
@@ -0,0 +1,86 @@
+-- A small stage for tests, with every force and a mix of terrains
+
+gstage = {
+    title_id = "Skirmish",
+    turn_limit = 20,
+    map = {
+        size = {12, 10},
+        terrain = {
+            "ffffmmffffff",
+            "ffffmmffffff",
+            "ffWWffffrrff",
+            "ffffffffrrff",
+            "fffffmmfffff",
+            "fffffmmfffff",
+            "ffrrffffWWff",
+            "ffrrffffffff",
+            "ffffffmmffff",
+            "ffffffmmffff"
+        },
+        file = "map"
+    },
+    deploy = {
+        unselectables = {},
+        num_required_selectables = 0,
+        selectables = {}
+    }
+}
+
+
+function on_deploy(game)
+end
+
+
+function on_begin(game)
+    local own = {
+        game:generate_unit("CaoCao", 10, Enum.force.own, {1, 1}),
+        game:generate_unit("XiahouDun", 8, Enum.force.own, {2, 1}),
+        game:generate_unit("XunYu", 8, Enum.force.own, {1, 2})
+    }
+    local allies = {
+        game:generate_unit("DianWei", 9, Enum.force.ally, {1, 8})
+    }
+    local enemies = {
+        game:generate_unit("LuBu", 9, Enum.force.enemy, {10, 8}),
+        game:generate_unit("Bandit", 7, Enum.force.enemy, {9, 8}),
+        game:generate_unit("Cavalry", 7, Enum.force.enemy, {10, 7}),
+        game:generate_unit("Bandit", 6, Enum.force.enemy, {6, 3})
+    }
+    for _, unit in ipairs(own) do
+        game:set_ai_mode(unit, "utility")
+    end
+    for _, unit in ipairs(allies) do
+        game:set_ai_mode(unit, "utility")
+    end
+    for _, unit in ipairs(enemies) do
+        game:set_ai_mode(unit, "unit_in_range_random")
+    end
+end
+
+
+function on_victory(game)
+end
+
+
+function on_defeat(game)
+end
+
+
+function end_condition(game)
+    if game:get_num_owns_alive() == 0 then
+        return Enum.status.defeat
+    end
+    if game:get_num_enemies_alive() == 0 then
+        return Enum.status.victory
+    end
+    return Enum.status.undecided
+end
+
+
+function main(game)
+    game:set_on_deploy(on_deploy)
+    game:set_on_begin(on_begin)
+    game:set_on_victory(on_victory)
+    game:set_on_defeat(on_defeat)
+    game:set_end_condition(end_condition)
+end
@@ -0,0 +1,63 @@
+-- Two pairs of the same units in the same surroundings at different places, for tests of what is local
+
+gstage = {
+    title_id = "Twins",
+    turn_limit = 20,
+    map = {
+        size = {12, 6},
+        terrain = {
+            "ffffffffffff",
+            "ffffffffffff",
+            "ffffffffffff",
+            "ffffffffffff",
+            "ffffffffffff",
+            "ffffffffffff"
+        },
+        file = "map"
+    },
+    deploy = {
+        unselectables = {},
+        num_required_selectables = 0,
+        selectables = {}
+    }
+}
+
+
+function on_deploy(game)
+end
+
+
+function on_begin(game)
+    game:generate_unit("Bandit", 5, Enum.force.own, {2, 2})
+    game:generate_unit("Bandit", 5, Enum.force.enemy, {3, 2})
+    game:generate_unit("Bandit", 5, Enum.force.own, {8, 3})
+    game:generate_unit("Bandit", 5, Enum.force.enemy, {9, 3})
+end
+
+
+function on_victory(game)
+end
+
+
+function on_defeat(game)
+end
+
+
+function end_condition(game)
+    if game:get_num_owns_alive() == 0 then
+        return Enum.status.defeat
+    end
+    if game:get_num_enemies_alive() == 0 then
+        return Enum.status.victory
+    end
+    return Enum.status.undecided
+end
+
+
+function main(game)
+    game:set_on_deploy(on_deploy)
+    game:set_on_begin(on_begin)
+    game:set_on_victory(on_victory)
+    game:set_on_defeat(on_defeat)
+    game:set_end_condition(end_condition)
+end
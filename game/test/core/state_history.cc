@@ -0,0 +1,92 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Main
+#include <boost/test/unit_test.hpp>
+
+#include "core/cmds.h"
+#include "core/unit.h"
+#include "core/user_interface.h"
+#include "test_stage.h"
+
+using namespace ::mengde::core;
+
+namespace {
+
+// What StateHistory takes back of the units, the map and the turn, in a form easy to compare
+vector<int> GetState(Stage* stage) {
+  vector<int> state;
+  stage->ForEachUnit([&](Unit* unit) {
+    state.push_back(unit->GetCurrentHpMp().hp);
+    state.push_back(unit->GetCurrentHpMp().mp);
+    state.push_back(static_cast<int>(unit->direction()));
+    state.push_back(unit->IsDoneAction());
+    state.push_back(unit->GetLevel());
+    state.push_back(unit->GetExp());
+    state.push_back(unit->position().x);
+    state.push_back(unit->position().y);
+    state.push_back(stage->GetUnitInCell(unit->position()) == unit);
+  });
+  state.push_back(stage->GetTurn().current());
+  state.push_back(static_cast<int>(stage->GetTurn().force()));
+  state.push_back(static_cast<int>(stage->GetStatus()));
+  return state;
+}
+
+int CountUnits(Stage* stage) {
+  int count = 0;
+  stage->ForEachUnit([&count](Unit*) { count++; });
+  return count;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(UndoRedoAction) {
+  const UId atk{0};
+  const UId def{1};
+  for (uint64_t seed = 0; seed < 10; seed++) {
+    TestStage stage("duel.lua", seed);
+    const vector<int> before = GetState(stage.get());
+    BOOST_CHECK(!stage->CanUndo());
+
+    // Moves next to the defender from the other side, so the position and the direction both change
+    auto action = std::make_unique<CmdAction>(CmdAction::Flag::kUserInput);
+    action->SetCmdMove(std::make_unique<CmdMove>(atk, Vec2D{3, 2}));
+    action->SetCmdAct(std::make_unique<CmdBasicAttack>(atk, def, CmdBasicAttack::Type::kActive));
+    stage->Push(std::move(action));
+    while (stage->HasNext()) stage->DoNext();
+    const vector<int> after = GetState(stage.get());
+    BOOST_REQUIRE(after != before);
+
+    BOOST_REQUIRE(stage->CanUndo());
+    BOOST_REQUIRE(stage->Undo());
+    const vector<int> undone = GetState(stage.get());
+    BOOST_CHECK_EQUAL_COLLECTIONS(undone.begin(), undone.end(), before.begin(), before.end());
+    BOOST_CHECK(!stage->CanUndo());
+
+    BOOST_REQUIRE(stage->CanRedo());
+    BOOST_REQUIRE(stage->Redo());
+    const vector<int> redone = GetState(stage.get());
+    BOOST_CHECK_EQUAL_COLLECTIONS(redone.begin(), redone.end(), after.begin(), after.end());
+    BOOST_CHECK(!stage->CanRedo());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(NoUndoAfterUnitsGenerated) {
+  TestStage stage("reinforcement.lua");
+  stage->SetUserControlled(false);
+
+  int num_units = CountUnits(stage.get());
+  while (stage->GetStatus() == Stage::Status::kUndecided) {
+    const bool could_undo = stage->CanUndo();
+    stage->user_interface()->PushPlayAI();
+    while (stage->HasNext()) stage->DoNext();
+    if (CountUnits(stage.get()) != num_units) {
+      // Taking back anything from before might put a unit where a generated one is
+      BOOST_CHECK(could_undo);
+      BOOST_CHECK(!stage->CanUndo());
+      BOOST_CHECK(!stage->Undo());
+      return;
+    }
+    num_units = CountUnits(stage.get());
+  }
+  BOOST_FAIL("No unit was generated");
+}
@@ -0,0 +1,37 @@
+#ifndef MENGDE_TEST_CORE_TEST_STAGE_H_
+#define MENGDE_TEST_CORE_TEST_STAGE_H_
+
+#include "core/scenario.h"
+#include "core/stage.h"
+#include "util/path.h"
+
+namespace mengde {
+namespace core {
+
+// TestStage is a stage of a script in `stage` played with the resources of the example scenario, already deployed
+//
+// The scenario is looked for next to the executable like the game does, where the build copies it. `prepare` is
+// called before the deploy, while the heroes of the stage's assets can still be changed.
+
+class TestStage {
+ public:
+  TestStage(const string& script, uint64_t seed = 0, const function<void(Stage*)>& prepare = nullptr)
+      : scenario_("example"),
+        stage_(std::make_unique<Stage>(scenario_.GetResourceManagers(), scenario_.GetAssets(),
+                                       Path(MENGDE_TEST_STAGE_DIR) / script)) {
+    stage_->Seed(seed);
+    if (prepare) prepare(stage_.get());
+    stage_->SubmitDeploy();
+  }
+  Stage* get() { return stage_.get(); }
+  Stage* operator->() { return stage_.get(); }
+
+ private:
+  Scenario scenario_;
+  unique_ptr<Stage> stage_;
+};
+
+}  // namespace core
+}  // namespace mengde
+
+#endif  // MENGDE_TEST_CORE_TEST_STAGE_H_
@@ -0,0 +1,50 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Main
+#include <boost/test/unit_test.hpp>
+
+#include "core/map.h"
+#include "core/threat_map.h"
+#include "core/unit.h"
+#include "test_stage.h"
+
+using namespace ::mengde::core;
+
+BOOST_AUTO_TEST_CASE(ParallelSameAsSerial) {
+  TestStage stage("skirmish.lua");
+  Map* map = stage->GetMap();
+  for (Force force : {Force::kOwn, Force::kAlly, Force::kEnemy}) {
+    ThreatMap serial(stage.get(), force);
+    ThreatMap parallel(stage.get(), force, true);
+    for (int y = 0; y < map->GetSize().y; y++) {
+      for (int x = 0; x < map->GetSize().x; x++) {
+        BOOST_CHECK(serial.IsReachable({x, y}) == parallel.IsReachable({x, y}));
+        BOOST_CHECK(serial.GetNumThreats({x, y}) == parallel.GetNumThreats({x, y}));
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SameAsEachUnit) {
+  TestStage stage("skirmish.lua");
+  Map* map = stage->GetMap();
+  ThreatMap threat_map(stage.get(), Force::kEnemy, true);
+  vector<int> num_threats(map->GetSize().x * map->GetSize().y, 0);
+  vector<bool> reachable(num_threats.size(), false);
+  stage->ForEachUnit([&](Unit* unit) {
+    if (unit->force() != Force::kEnemy) return;
+    vector<bool> threatened(num_threats.size(), false);
+    for (Vec2D c : stage->FindMovablePos(unit)) {
+      reachable[map->SerializeVec2D(c)] = true;
+      unit->attack_range().ForEach(
+          [&](Vec2D pos) {
+            if (map->IsValidCoords(pos)) threatened[map->SerializeVec2D(pos)] = true;
+          },
+          c);
+    }
+    for (uint32_t i = 0; i < threatened.size(); i++) num_threats[i] += threatened[i];
+  });
+  for (uint32_t i = 0; i < num_threats.size(); i++) {
+    BOOST_CHECK(threat_map.IsReachable(map->DeserializeVec2D(i)) == reachable[i]);
+    BOOST_CHECK(threat_map.GetNumThreats(map->DeserializeVec2D(i)) == num_threats[i]);
+  }
+}
@@ -0,0 +1,69 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Main
+#include <boost/test/unit_test.hpp>
+
+#include "util/rng.h"
+
+BOOST_AUTO_TEST_CASE(SameSeedSameSequence) {
+  Rng a(42);
+  Rng b(42);
+  for (int i = 0; i < 1000; i++) {
+    BOOST_CHECK_EQUAL(a.Next(), b.Next());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Reseed) {
+  Rng a(7);
+  uint32_t first = a.Next();
+  a.Next();
+  a.Seed(7);
+  BOOST_CHECK_EQUAL(a.Next(), first);
+}
+
+BOOST_AUTO_TEST_CASE(CopyForks) {
+  Rng a(3);
+  a.Next();
+  Rng b = a;
+  for (int i = 0; i < 100; i++) {
+    BOOST_CHECK_EQUAL(a.Next(), b.Next());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GenRange) {
+  Rng rng(1);
+  int counts[10] = {0};
+  for (int i = 0; i < 10000; i++) {
+    int v = rng.Gen(10);
+    BOOST_REQUIRE(0 <= v && v < 10);
+    counts[v]++;
+  }
+  for (int c : counts) {
+    BOOST_CHECK(c > 800 && c < 1200);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SplitGoesOn) {
+  Rng a(5);
+  Rng b(5);
+  Rng stream = a.Split();
+  for (int i = 0; i < 100; i++) {
+    BOOST_CHECK_EQUAL(stream.Next(), b.Next());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SplitStreamsDiffer) {
+  Rng a(5);
+  Rng b(5);
+  Rng stream1 = a.Split();
+  Rng stream2 = a.Split();
+  b.Split();
+  Rng stream3 = b.Split();
+  int same = 0;
+  for (int i = 0; i < 1000; i++) {
+    const uint32_t v1 = stream1.Next();
+    const uint32_t v2 = stream2.Next();
+    BOOST_CHECK_EQUAL(v2, stream3.Next());
+    if (v1 == v2) same++;
+  }
+  BOOST_CHECK(same < 2);
+}
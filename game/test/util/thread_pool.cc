@@ -0,0 +1,51 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Main
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <stdexcept>
+
+#include "util/thread_pool.h"
+
+BOOST_AUTO_TEST_CASE(EveryIndexOnce) {
+  ThreadPool pool(3);
+  vector<int> counts(1000, 0);
+  pool.ParallelFor(counts.size(), [&](int i) { counts[i]++; });
+  BOOST_CHECK(std::all_of(counts.begin(), counts.end(), [](int c) { return c == 1; }));
+}
+
+BOOST_AUTO_TEST_CASE(Reuse) {
+  ThreadPool pool(2);
+  std::atomic<int> sum{0};
+  for (int round = 0; round < 100; round++) {
+    pool.ParallelFor(10, [&](int i) { sum += i; });
+  }
+  BOOST_CHECK(sum == 100 * 45);
+}
+
+BOOST_AUTO_TEST_CASE(Nested) {
+  ThreadPool pool(2);
+  std::atomic<int> count{0};
+  pool.ParallelFor(4, [&](int) { pool.ParallelFor(4, [&](int) { count++; }); });
+  BOOST_CHECK(count == 16);
+}
+
+BOOST_AUTO_TEST_CASE(NoWorkers) {
+  ThreadPool pool(0);
+  int sum = 0;
+  pool.ParallelFor(5, [&](int i) { sum += i; });
+  BOOST_CHECK(sum == 10);
+}
+
+BOOST_AUTO_TEST_CASE(Throw) {
+  ThreadPool pool(3);
+  auto job = [](int i) {
+    if (i == 10) throw std::runtime_error("job");
+  };
+  BOOST_CHECK_THROW(pool.ParallelFor(100, job), std::runtime_error);
+
+  // The pool is still usable afterwards
+  std::atomic<int> sum{0};
+  pool.ParallelFor(10, [&](int i) { sum += i; });
+  BOOST_CHECK(sum == 45);
+}